@@ -0,0 +1,356 @@
+// Playback timing-fidelity benchmark: replays a corpus of synthetic and recorded sequences
+// through PlaybackEngine into a LoopbackSink and reports, per sequence, lateness
+// percentiles, cumulative drift and CPU time, plus the engine's events/sec ceiling and
+// the save/load cost of each sequence file format and the timeline's build and repaint cost.
+// Output is JSON so results can be compared across commits.
+//
+// Build with -DCRAFTIUM_BUILD_BENCHMARKS=ON and run
+//   ./craftium_bench [--repeat N] [--gap-us N] [--spin-us N] [--batch-us N] [--speed X] [--realtime] [--cpu N] [--output results.json] [sequence.json ...]
+// With no sequence files, "test sequence.json" from the source tree is used.
+// Lateness is measured against each event's own deadline, so events sent early as part
+// of a batch show up as negative values. Run with and without --realtime to compare
+// missed deadlines between the normal and low-latency thread modes.
+
+#include "../include/keytables.h"
+#include "../include/loopbacksink.h"
+#include "../include/playbackengine.h"
+#include "../include/sequencefile.h"
+#include "../include/timelineindex.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef CRAFTIUM_SOURCE_DIR
+#define CRAFTIUM_SOURCE_DIR "."
+#endif
+
+namespace {
+
+using Clock = PlaybackClock::Clock;
+
+struct Corpus {
+    QString name;
+    std::vector<KeyEvent> events;
+};
+
+KeyEvent makeEvent(const char* keyName, bool isDown, uint32_t delayUs) {
+    const int code = KeyTables::codeForName(keyName);
+    return KeyEvent(KeyNames::intern(keyName), static_cast<uint16_t>(code < 0 ? 0 : code), isDown, delayUs);
+}
+
+// Evenly spaced press/release pairs
+std::vector<KeyEvent> steady(size_t count, uint32_t intervalUs) {
+    std::vector<KeyEvent> events;
+    events.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        events.push_back(makeEvent("a", i % 2 == 0, intervalUs));
+    }
+    return events;
+}
+
+// Four-key chords: three zero-delay followers after each gap
+std::vector<KeyEvent> chords(size_t chordCount, uint32_t gapUs) {
+    static const char* const keys[] = {"a", "s", "d", "f"};
+    std::vector<KeyEvent> events;
+    events.reserve(chordCount * 8);
+    for (size_t c = 0; c < chordCount; ++c) {
+        for (int k = 0; k < 4; ++k) events.push_back(makeEvent(keys[k], true, k == 0 ? gapUs : 0));
+        for (int k = 0; k < 4; ++k) events.push_back(makeEvent(keys[k], false, k == 0 ? gapUs : 0));
+    }
+    return events;
+}
+
+// Typing-like random gaps, seeded so every run replays the same schedule
+std::vector<KeyEvent> jitter(size_t count, uint32_t maxGapUs) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<uint32_t> gap(0, maxGapUs);
+    std::vector<KeyEvent> events;
+    events.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        events.push_back(makeEvent("j", i % 2 == 0, gap(rng)));
+    }
+    return events;
+}
+
+double toUs(Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+double cpuMs(std::clock_t start, std::clock_t end) {
+    return 1000.0 * static_cast<double>(end - start) / CLOCKS_PER_SEC;
+}
+
+// Nearest-rank percentile of an ascending vector
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+QJsonObject runCase(PlaybackEngine& engine, const Corpus& corpus, int repeatCount) {
+    LoopbackSink sink(corpus.events.size() * static_cast<size_t>(repeatCount));
+
+    const std::clock_t cpuStart = std::clock();
+    const PlaybackEngine::Report report = engine.run(corpus.events, repeatCount, sink);
+    const std::clock_t cpuEnd = std::clock();
+    const double wallMs = toUs(Clock::now() - report.origin) / 1000.0;
+
+    // Rebuild the schedule the engine followed and compare each send against it
+    const PlaybackTape tape = PlaybackTape::compile(corpus.events, engine.timing(), engine.batchThreshold(),
+                                                    PlaybackEngine::kMaxBatchSize);
+    std::vector<double> lateness;
+    lateness.reserve(sink.events().size());
+    Clock::time_point passStart = report.origin;
+    size_t sent = 0;
+    for (int rep = 0; rep < repeatCount && sent < sink.events().size(); ++rep) {
+        if (rep > 0) passStart += std::chrono::microseconds(tape.durationUs) + engine.repeatGap();
+        for (size_t i = 0; i < tape.eventOffsetsUs.size() && sent < sink.events().size(); ++i) {
+            const Clock::time_point deadline = passStart + std::chrono::microseconds(tape.eventOffsetsUs[i]);
+            const Clock::time_point actual{std::chrono::nanoseconds(sink.events()[sent++].timestampNs)};
+            lateness.push_back(toUs(actual - deadline));
+        }
+    }
+
+    const double firstLateness = lateness.empty() ? 0.0 : lateness.front();
+    const double lastLateness = lateness.empty() ? 0.0 : lateness.back();
+    double sum = 0.0;
+    for (double l : lateness) sum += l;
+
+    std::vector<double> sorted = lateness;
+    std::sort(sorted.begin(), sorted.end());
+
+    const double cpu = cpuMs(cpuStart, cpuEnd);
+
+    QJsonObject latenessObj;
+    latenessObj["p50"] = percentile(sorted, 0.50);
+    latenessObj["p99"] = percentile(sorted, 0.99);
+    latenessObj["p99_9"] = percentile(sorted, 0.999);
+    latenessObj["max"] = sorted.empty() ? 0.0 : sorted.back();
+    latenessObj["mean"] = lateness.empty() ? 0.0 : sum / static_cast<double>(lateness.size());
+
+    QJsonObject result;
+    result["name"] = corpus.name;
+    result["events"] = static_cast<qint64>(lateness.size());
+    result["pass_duration_ms"] = static_cast<double>(report.passDurationUs) / 1000.0;
+    result["lateness_us"] = latenessObj;
+    // How far the last event slipped relative to the first one
+    result["drift_us"] = lastLateness - firstLateness;
+    result["wall_ms"] = wallMs;
+    result["cpu_ms"] = cpu;
+    result["cpu_utilization"] = wallMs > 0.0 ? cpu / wallMs : 0.0;
+    result["batches"] = static_cast<qint64>(report.batches);
+    result["missed_deadlines"] = static_cast<qint64>(report.missedDeadlines);
+    result["thread_mode"] = QString::fromStdString(report.threadMode);
+    result["completed"] = report.completed;
+    return result;
+}
+
+// Upper bound on dispatch rate: zero-delay events, nothing to wait for
+QJsonObject runThroughput(PlaybackEngine& engine, size_t count) {
+    const std::vector<KeyEvent> events = steady(count, 0);
+    LoopbackSink sink(count);
+
+    const std::clock_t cpuStart = std::clock();
+    const Clock::time_point start = Clock::now();
+    const PlaybackEngine::Report report = engine.run(events, 1, sink);
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const std::clock_t cpuEnd = std::clock();
+
+    QJsonObject result;
+    result["events"] = static_cast<qint64>(count);
+    result["events_per_sec"] = seconds > 0.0 ? static_cast<double>(count) / seconds : 0.0;
+    result["batches"] = static_cast<qint64>(report.batches);
+    result["cpu_ms"] = cpuMs(cpuStart, cpuEnd);
+    return result;
+}
+
+// Save and load cost per file format on a large recording
+QJsonObject runFileFormats(size_t count) {
+    const std::vector<KeyEvent> events = jitter(count, 8000);
+    QJsonObject result;
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return result;
+    }
+
+    for (const char* suffix : {"json", SequenceFile::kBinarySuffix}) {
+        const QString path = dir.filePath(QString("bench.") + suffix);
+        const Clock::time_point saveStart = Clock::now();
+        const bool saved = SequenceFile::save(path, events);
+        const double saveMs = toUs(Clock::now() - saveStart) / 1000.0;
+
+        std::vector<KeyEvent> loaded;
+        const Clock::time_point loadStart = Clock::now();
+        const bool ok = saved && SequenceFile::load(path, &loaded);
+        const double loadMs = toUs(Clock::now() - loadStart) / 1000.0;
+
+        const qint64 bytes = QFileInfo(path).size();
+        QJsonObject format;
+        format["events"] = static_cast<qint64>(count);
+        format["bytes"] = bytes;
+        format["bytes_per_event"] = count > 0 ? static_cast<double>(bytes) / static_cast<double>(count) : 0.0;
+        format["save_ms"] = saveMs;
+        format["load_ms"] = loadMs;
+        format["load_mb_per_sec"] = loadMs > 0.0 ? static_cast<double>(bytes) / 1e6 / (loadMs / 1000.0) : 0.0;
+        format["round_trip_ok"] = ok && loaded.size() == events.size();
+        result[suffix] = format;
+    }
+    return result;
+}
+
+// Timeline index build time, the cost of folding in one refresh's worth of new events,
+// and the per-repaint sampling cost, fully zoomed out and in. Appends and sampling should
+// stay flat as the sequence grows.
+QJsonObject runTimeline(size_t count) {
+    constexpr size_t kColumns = 1000;
+    const std::vector<KeyEvent> events = jitter(count, 8000);
+
+    constexpr size_t kTailEvents = 1000;
+    const size_t tail = std::min(kTailEvents, events.size());
+    TimelineIndex index;
+    const Clock::time_point buildStart = Clock::now();
+    index.build(std::vector<KeyEvent>(events.begin(), events.end() - static_cast<std::ptrdiff_t>(tail)));
+    const double buildMs = toUs(Clock::now() - buildStart) / 1000.0;
+    const Clock::time_point appendStart = Clock::now();
+    index.append(events.data() + events.size() - tail, tail);
+    const double appendUs = toUs(Clock::now() - appendStart);
+
+    std::vector<TimelineIndex::Column> columns;
+    auto sampleAllLanes = [&](double startUs, double usPerColumn) {
+        const Clock::time_point start = Clock::now();
+        for (size_t lane = 0; lane < index.laneCount(); ++lane) {
+            index.sample(lane, startUs, usPerColumn, kColumns, &columns);
+        }
+        return toUs(Clock::now() - start);
+    };
+    const double duration = static_cast<double>(index.durationUs());
+
+    QJsonObject result;
+    result["events"] = static_cast<qint64>(count);
+    result["lanes"] = static_cast<qint64>(index.laneCount());
+    result["build_ms"] = buildMs;
+    result["append_1000_us"] = appendUs;
+    result["full_view_sample_us"] = sampleAllLanes(0.0, duration / kColumns);
+    result["zoomed_view_sample_us"] = sampleAllLanes(duration / 2.0, 100.0);
+    return result;
+}
+
+void usage() {
+    std::fprintf(stderr, "usage: craftium_bench [--repeat N] [--gap-us N] [--spin-us N] [--batch-us N] [--speed X] [--realtime] [--cpu N] [--output file] [sequence.json ...]\n");
+}
+
+} // end anonymous namespace
+
+int main(int argc, char* argv[]) {
+    int repeatCount = 1;
+    long long gapUs = std::chrono::microseconds(PlaybackEngine::kDefaultRepeatGap).count();
+    long long spinUs = PlaybackClock::kDefaultSpinThreshold.count();
+    long long batchUs = PlaybackEngine::kDefaultBatchThreshold.count();
+    PlaybackTiming timing;
+    RealtimeOptions realtime;
+    QString outputPath;
+    QStringList files;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeatCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--gap-us" && i + 1 < argc) {
+            gapUs = std::max(0LL, std::atoll(argv[++i]));
+        } else if (arg == "--spin-us" && i + 1 < argc) {
+            spinUs = std::max(0LL, std::atoll(argv[++i]));
+        } else if (arg == "--batch-us" && i + 1 < argc) {
+            batchUs = std::max(0LL, std::atoll(argv[++i]));
+        } else if (arg == "--speed" && i + 1 < argc) {
+            timing.speed = std::atof(argv[++i]);
+        } else if (arg == "--realtime") {
+            realtime.enabled = true;
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            realtime.cpu = std::atoi(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputPath = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage();
+            return 2;
+        } else {
+            files << QString::fromLocal8Bit(argv[i]);
+        }
+    }
+    if (files.isEmpty()) {
+        files << QString(CRAFTIUM_SOURCE_DIR) + "/test sequence.json";
+    }
+
+    std::vector<Corpus> corpus;
+    corpus.push_back({"synthetic/steady_1ms", steady(1000, 1000)});
+    corpus.push_back({"synthetic/sub_ms_250us", steady(2000, 250)});
+    corpus.push_back({"synthetic/chords_20ms", chords(50, 20000)});
+    corpus.push_back({"synthetic/jitter_0-8ms", jitter(500, 8000)});
+    for (const QString& file : files) {
+        Corpus recorded{"recorded/" + QFileInfo(file).fileName(), {}};
+        QString error;
+        if (!SequenceFile::load(file, &recorded.events, &error)) {
+            std::fprintf(stderr, "Skipping %s: %s\n", qPrintable(file), qPrintable(error));
+            continue;
+        }
+        corpus.push_back(std::move(recorded));
+    }
+
+    PlaybackEngine engine;
+    engine.setPreroll(std::chrono::microseconds(0));
+    engine.setRepeatGap(std::chrono::microseconds(gapUs));
+    engine.setSpinThreshold(std::chrono::microseconds(spinUs));
+    engine.setBatchThreshold(std::chrono::microseconds(batchUs));
+    engine.setTiming(timing);
+    engine.setRealtime(realtime);
+
+    QJsonArray cases;
+    for (const Corpus& c : corpus) {
+        std::fprintf(stderr, "Running %s (%zu events)...\n", qPrintable(c.name), c.events.size());
+        cases.append(runCase(engine, c, repeatCount));
+    }
+
+    QJsonObject root;
+    root["benchmark"] = "craftium_playback";
+    root["host"] = QSysInfo::prettyProductName();
+    root["cpu_arch"] = QSysInfo::currentCpuArchitecture();
+    root["spin_threshold_us"] = spinUs;
+    root["batch_threshold_us"] = batchUs;
+    root["speed"] = timing.speed;
+    root["realtime_requested"] = realtime.enabled;
+    root["cpu"] = realtime.cpu;
+    root["repeat"] = repeatCount;
+    root["repeat_gap_us"] = gapUs;
+    root["cases"] = cases;
+    root["throughput"] = runThroughput(engine, 200000);
+    root["file_formats"] = runFileFormats(1000000);
+    root["timeline"] = runTimeline(1000000);
+
+    const QByteArray json = QJsonDocument(root).toJson();
+    if (outputPath.isEmpty()) {
+        std::fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+    } else {
+        QFile out(outputPath);
+        if (!out.open(QIODevice::WriteOnly) || out.write(json) < 0) {
+            std::fprintf(stderr, "Could not write %s\n", qPrintable(outputPath));
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Microbenchmark: compile-time KeyTable lookups vs. the std::map tables they replaced.
+// Build with -DCRAFTIUM_BUILD_BENCHMARKS=ON and run ./keytables_bench [iterations].
+
+#include "../include/keytables.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the optimizer from discarding lookup results
+volatile size_t g_sink = 0;
+
+double nsPerOp(Clock::duration elapsed, size_t ops) {
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(ops);
+}
+
+} // end anonymous namespace
+
+int main(int argc, char* argv[]) {
+    const size_t iterations = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    std::vector<uint16_t> codes;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < KeyTables::size(); ++i) {
+        const KeyTableEntry& entry = KeyTables::entry(i);
+        if (!entry.alias) {
+            codes.push_back(entry.code);
+        }
+        names.emplace_back(entry.name);
+    }
+
+    // Baseline: what ControllerApp used to build at static-init / first use
+    const auto buildStart = Clock::now();
+    std::map<uint16_t, std::string> codeToName;
+    std::map<std::string, uint16_t> nameToCode;
+    for (size_t i = 0; i < KeyTables::size(); ++i) {
+        const KeyTableEntry& entry = KeyTables::entry(i);
+        if (!entry.alias) {
+            codeToName.emplace(entry.code, std::string(entry.name));
+        }
+        nameToCode.emplace(std::string(entry.name), entry.code);
+    }
+    const auto buildElapsed = Clock::now() - buildStart;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        const auto it = codeToName.find(codes[i % codes.size()]);
+        g_sink = g_sink + (it != codeToName.end() ? it->second.size() : 0);
+    }
+    const double mapCodeNs = nsPerOp(Clock::now() - start, iterations);
+
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        g_sink = g_sink + KeyTables::nameForCode(codes[i % codes.size()]).size();
+    }
+    const double tableCodeNs = nsPerOp(Clock::now() - start, iterations);
+
+    // The old macOS stringToKeyCode scanned the non-printable map linearly first
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        const std::string& name = names[i % names.size()];
+        size_t found = 0;
+        for (const auto& [code, candidate] : codeToName) {
+            if (candidate == name) {
+                found = code;
+                break;
+            }
+        }
+        if (found == 0) {
+            const auto it = nameToCode.find(name);
+            found = (it != nameToCode.end()) ? it->second : 0;
+        }
+        g_sink = g_sink + found;
+    }
+    const double scanNameNs = nsPerOp(Clock::now() - start, iterations);
+
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        const auto it = nameToCode.find(names[i % names.size()]);
+        g_sink = g_sink + (it != nameToCode.end() ? it->second : 0);
+    }
+    const double mapNameNs = nsPerOp(Clock::now() - start, iterations);
+
+    start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        g_sink = g_sink + static_cast<size_t>(KeyTables::codeForName(names[i % names.size()]));
+    }
+    const double tableNameNs = nsPerOp(Clock::now() - start, iterations);
+
+    std::printf("entries: %zu, iterations: %zu\n", KeyTables::size(), iterations);
+    std::printf("std::map construction:        %10.1f us (KeyTable: 0, built by the compiler)\n",
+                std::chrono::duration<double, std::micro>(buildElapsed).count());
+    std::printf("code -> name  std::map:       %10.2f ns/op\n", mapCodeNs);
+    std::printf("code -> name  KeyTable:       %10.2f ns/op\n", tableCodeNs);
+    std::printf("name -> code  scan + map:     %10.2f ns/op\n", scanNameNs);
+    std::printf("name -> code  std::map:       %10.2f ns/op\n", mapNameNs);
+    std::printf("name -> code  KeyTable:       %10.2f ns/op\n", tableNameNs);
+    return 0;
+}
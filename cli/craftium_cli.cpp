@@ -0,0 +1,327 @@
+// Headless player and recorder for scripts and CI.
+//
+//   craftium-cli play <file> [--repeat N] [--speed X] [--gap-ms N] [--preroll-ms N]
+//                            [--realtime] [--cpu N] [--loopback]
+//   craftium-cli record --out <file> [--duration S]
+//   craftium-cli convert <in> <out>
+//
+// Links QtCore only and never creates a QCoreApplication, QSettings or any widget, so
+// start-up is the file load plus opening the injection backend. play prints a one-line
+// summary on stderr, including the time from process start to the first deadline.
+// A repeat count of 0 loops until interrupted; Ctrl+C stops play and record cleanly.
+
+#include "../include/inputbackend.h"
+#include "../include/keyrecorder.h"
+#include "../include/keytables.h"
+#include "../include/loopbacksink.h"
+#include "../include/playbackengine.h"
+#include "../include/sequencefile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <CoreFoundation/CoreFoundation.h>
+#include <csignal>
+#include <pthread.h>
+#else
+#include <csignal>
+#include <pthread.h>
+#endif
+
+namespace { // Use an anonymous namespace to limit scope
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point g_processStart = Clock::now();
+std::atomic<bool> g_stopRequested{false};
+std::atomic<PlaybackEngine*> g_activeEngine{nullptr};
+
+void requestStop() {
+    g_stopRequested = true;
+    if (PlaybackEngine* engine = g_activeEngine.load()) {
+        engine->stop(); // Thread-safe; releases held keys on the playback thread
+    }
+}
+
+#ifdef _WIN32
+BOOL WINAPI consoleHandler(DWORD type) {
+    if (type == CTRL_C_EVENT || type == CTRL_BREAK_EVENT || type == CTRL_CLOSE_EVENT) {
+        requestStop(); // Runs on its own thread, so ordinary locking is fine
+        return TRUE;
+    }
+    return FALSE;
+}
+#endif
+
+// Routes Ctrl+C and SIGTERM to requestStop(). On POSIX the signals are blocked in every
+// thread and taken by sigwait() on a helper thread, where calling into the engine is safe.
+void installStopHandler() {
+#ifdef _WIN32
+    SetConsoleCtrlHandler(consoleHandler, TRUE);
+#else
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread([signals] {
+        int received = 0;
+        while (sigwait(&signals, &received) == 0) {
+            requestStop();
+        }
+    }).detach();
+#endif
+}
+
+// Waits for a stop request or the deadline while servicing the platform's event
+// delivery: the Windows hook and the macOS event tap run on this thread.
+void waitForStop(Clock::time_point deadline) {
+    constexpr std::chrono::milliseconds kPollInterval{10};
+    while (!g_stopRequested && Clock::now() < deadline) {
+#ifdef _WIN32
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, static_cast<DWORD>(kPollInterval.count()), QS_ALLINPUT);
+        MSG msg;
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+#elif defined(__APPLE__)
+        CFRunLoopRunInMode(kCFRunLoopDefaultMode, std::chrono::duration<double>(kPollInterval).count(), true);
+#else
+        std::this_thread::sleep_for(kPollInterval);
+#endif
+    }
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: craftium-cli play <file> [--repeat N] [--speed X] [--gap-ms N] [--preroll-ms N]\n"
+                 "                                [--realtime] [--cpu N] [--loopback]\n"
+                 "       craftium-cli record --out <file> [--duration S]\n"
+                 "       craftium-cli convert <in> <out>\n");
+}
+
+bool loadSequence(const std::string& path, std::vector<KeyEvent>* events) {
+    QString error;
+    if (!SequenceFile::load(QString::fromLocal8Bit(path.c_str()), events, &error)) {
+        std::fprintf(stderr, "craftium-cli: %s: %s\n", path.c_str(), qPrintable(error));
+        return false;
+    }
+    return true;
+}
+
+bool saveSequence(const std::string& path, const std::vector<KeyEvent>& events) {
+    QString error;
+    if (!SequenceFile::save(QString::fromLocal8Bit(path.c_str()), events, &error)) {
+        std::fprintf(stderr, "craftium-cli: %s: %s\n", path.c_str(), qPrintable(error));
+        return false;
+    }
+    return true;
+}
+
+int play(int argc, char* argv[]) {
+    std::string path;
+    int repeatCount = 1;
+    PlaybackTiming timing;
+    RealtimeOptions realtime;
+    long long gapMs = 0;
+    // Scripts have already focused their target. A new uinput device still needs its
+    // settle time before the first event; the engine waits that out on its own.
+    long long prerollMs = 0;
+    bool loopback = false;
+
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeatCount = std::max(PlaybackEngine::kRepeatForever, std::atoi(argv[++i]));
+        } else if (arg == "--speed" && i + 1 < argc) {
+            timing.speed = std::atof(argv[++i]);
+        } else if (arg == "--gap-ms" && i + 1 < argc) {
+            gapMs = std::max(0LL, std::atoll(argv[++i]));
+        } else if (arg == "--preroll-ms" && i + 1 < argc) {
+            prerollMs = std::max(0LL, std::atoll(argv[++i]));
+        } else if (arg == "--realtime") {
+            realtime.enabled = true;
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            realtime.cpu = std::atoi(argv[++i]);
+        } else if (arg == "--loopback") {
+            loopback = true;
+        } else if (path.empty() && !arg.empty() && arg[0] != '-') {
+            path = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (path.empty()) {
+        usage();
+        return 2;
+    }
+
+    std::vector<KeyEvent> events;
+    if (!loadSequence(path, &events)) {
+        return 1;
+    }
+
+    // --loopback exercises the whole pipeline without touching the OS input queue. Nothing
+    // reads the sent events back, so they are only counted: --repeat 0 loops without growing.
+    std::unique_ptr<InputSink> sink =
+        loopback ? std::make_unique<LoopbackSink>(0, false) : createPlatformSink();
+    if (!sink) {
+        std::fprintf(stderr, "craftium-cli: key injection is not supported on this platform\n");
+        return 1;
+    }
+    std::string sinkError;
+    if (!sink->open(&sinkError)) {
+        std::fprintf(stderr, "craftium-cli: %s sink could not be opened: %s\n", sink->name(), sinkError.c_str());
+        return 1;
+    }
+
+    PlaybackEngine engine;
+    engine.setPreroll(std::chrono::milliseconds(prerollMs));
+    engine.setRepeatGap(std::chrono::milliseconds(gapMs));
+    engine.setTiming(timing);
+    engine.setRealtime(realtime);
+
+    // Arm before publishing the engine: a Ctrl+C from here on either finds the engine and
+    // stops the armed run, or is seen by the check below
+    engine.arm();
+    g_activeEngine = &engine;
+    if (g_stopRequested) {
+        engine.stop();
+    }
+    const PlaybackEngine::Report report = engine.run(events, repeatCount, *sink);
+    g_activeEngine = nullptr;
+    sink->close();
+    if (g_stopRequested && report.origin == PlaybackClock::TimePoint()) {
+        return 1;  // Stopped before the run began; nothing was sent
+    }
+
+    const auto startupUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        report.origin + report.preroll - g_processStart).count();
+    std::fprintf(stderr,
+                 "craftium-cli: %s %zu events in %zu batches over %llu passes, %zu failed, "
+                 "worst lateness %lld us, %zu missed deadlines, start-up %lld us, thread %s\n",
+                 report.completed ? "played" : "stopped after", report.eventsSent, report.batches,
+                 static_cast<unsigned long long>(report.passes), report.sendFailures,
+                 static_cast<long long>(report.worstLateness.count()), report.missedDeadlines,
+                 static_cast<long long>(startupUs), report.threadMode.c_str());
+    if (!report.threadWarnings.empty()) {
+        std::fprintf(stderr, "craftium-cli: low-latency mode incomplete: %s\n", report.threadWarnings.c_str());
+    }
+    return report.sendFailures == 0 ? 0 : 1;
+}
+
+int record(int argc, char* argv[]) {
+    std::string outPath;
+    double durationSeconds = 0.0;  // 0 records until interrupted
+
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--duration" && i + 1 < argc) {
+            durationSeconds = std::max(0.0, std::atof(argv[++i]));
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (outPath.empty()) {
+        usage();
+        return 2;
+    }
+
+    std::unique_ptr<InputSource> source = createPlatformSource();
+    if (!source) {
+        std::fprintf(stderr, "craftium-cli: key capture is not supported on this platform\n");
+        return 1;
+    }
+
+    // Only the drain thread appends, and it is joined before the events are read
+    std::vector<KeyEvent> events;
+    KeyRecorder recorder;
+    recorder.start(
+        [](uint16_t code) {
+            const std::string_view name = KeyTables::nameForCode(code);
+            return name.empty() ? KeyNames::kUnknown : KeyNames::intern(std::string(name));
+        },
+        [&events](const KeyEvent* batch, size_t count) { events.insert(events.end(), batch, batch + count); });
+
+    std::string sourceError;
+    if (!source->start([&recorder](uint16_t code, bool isPress, int64_t timestampNs) {
+            recorder.pushAt(code, isPress, timestampNs);
+        }, &sourceError)) {
+        recorder.stop();
+        std::fprintf(stderr, "craftium-cli: could not start key capture: %s\n", sourceError.c_str());
+        return 1;
+    }
+
+    std::fprintf(stderr, "craftium-cli: recording, press Ctrl+C to stop\n");
+    waitForStop(durationSeconds > 0.0
+        ? Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(durationSeconds))
+        : Clock::time_point::max());
+
+    source->stop();
+    recorder.stop();
+    if (recorder.droppedEvents() > 0) {
+        std::fprintf(stderr, "craftium-cli: %llu events were dropped\n",
+                     static_cast<unsigned long long>(recorder.droppedEvents()));
+    }
+
+    if (!saveSequence(outPath, events)) {
+        return 1;
+    }
+    std::fprintf(stderr, "craftium-cli: recorded %zu events to %s\n", events.size(), outPath.c_str());
+    return 0;
+}
+
+int convert(int argc, char* argv[]) {
+    if (argc != 2) {
+        usage();
+        return 2;
+    }
+    // Loading fills in microsecond delays and platform codes, so this also upgrades older files
+    std::vector<KeyEvent> events;
+    if (!loadSequence(argv[0], &events) || !saveSequence(argv[1], events)) {
+        return 1;
+    }
+    return 0;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    installStopHandler();
+
+    const std::string command = argv[1];
+    if (command == "play") {
+        return play(argc - 2, argv + 2);
+    } else if (command == "record") {
+        return record(argc - 2, argv + 2);
+    } else if (command == "convert") {
+        return convert(argc - 2, argv + 2);
+    } else if (command == "--help" || command == "-h") {
+        usage();
+        return 0;
+    }
+    usage();
+    return 2;
+}
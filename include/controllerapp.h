@@ -6,6 +6,7 @@
 #include <QThread>
 #include <QLabel>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QTextEdit>
 #include <QPushButton>
 #include <QPropertyAnimation>
@@ -15,10 +16,8 @@
 #include <QScopedValueRollback>
 #include <string>
 #include <vector>
-#include <map>
 #include <chrono>
 #include <QSettings>
-#include <QMutex>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -27,21 +26,24 @@
 #include <CoreGraphics/CoreGraphics.h>
 #endif
 
-class PlaybackWorker;
+#include <memory>
+#include "inputbackend.h"
+#include "keyevent.h"
+#include "keyrecorder.h"
+#include "keysequence.h"
+#include "playbacktape.h"
+#include "realtimethread.h"
+#include "recordingjournal.h"
 
-struct KeyEvent {
-    std::string key;
-    std::string state;
-    long long delay;
-#ifdef _WIN32
-    WORD winKeyCode;
-#elif defined(__APPLE__)
-    CGKeyCode macKeyCode;
-#endif
-};
+class PlaybackWorker;
+class SequenceIoWorker;
+class SequenceListModel;
+class TimelineWidget;
+class QListView;
+class QTimer;
 
 #include <QMetaType>
-Q_DECLARE_METATYPE(std::vector<KeyEvent>)
+Q_DECLARE_METATYPE(SequenceSnapshot)
 
 class ControllerApp : public QWidget {
     Q_OBJECT
@@ -50,11 +52,6 @@ public:
     explicit ControllerApp(QWidget *parent = nullptr);
     ~ControllerApp() override;
 
-    // Moved from private to public for callback access
-#ifdef __APPLE__
-    void recordKeyEvent(CGKeyCode keyCode, bool isPress);
-#endif
-
     // Public getter for recording state
     bool isRecording() const;
 
@@ -63,6 +60,7 @@ public slots:
     void stopRecording();
     void startPlayback(int repeatCount = 1, bool external = false);
     void stopPlayback();
+    void togglePausePlayback();
     void saveSequence();
     void loadSequence();
     void clearSequence();
@@ -78,11 +76,15 @@ public slots:
     void showHelpDialog();
 
 signals:
-    void startPlaybackSignal(const std::vector<KeyEvent>& sequence);
+    void startPlaybackSignal(const SequenceSnapshot& sequence);
     void stopPlaybackSignal();
+    void loadFileSignal(quint64 request, const QString& fileName);
+    void saveFileSignal(quint64 request, const QString& fileName, const SequenceSnapshot& sequence);
 
 private slots:
-    void handlePlaybackFinished();
+    void handlePlaybackFinished(const QString& error);
+    void cancelFileOperation();
+    void recoverJournal();
     void saveNotesToFile();
     void loadNotesFromFile();
 
@@ -98,40 +100,85 @@ private:
 #ifdef _WIN32
     std::string vkCodeToString(DWORD vkCode) const;
     WORD stringToVkCode(const std::string& keyName) const;
-    void startGlobalKeyListener();
-    void stopGlobalKeyListener();
-    void recordKeyEvent(DWORD vkCode, bool isPress);
 #elif defined(__APPLE__)
     std::string keyCodeToString(CGKeyCode keyCode) const;
     CGKeyCode stringToKeyCode(const std::string& keyName) const;
-    bool startGlobalKeyListener();
-    void stopGlobalKeyListener();
     bool hasInputMonitoringPermission() const;
     void checkAndRequestAccessibilityPermissions();
-    CFMachPortRef eventTap = nullptr;
-    CFRunLoopSourceRef runLoopSource = nullptr;
 #endif
 
+    // Recorder plumbing: the input source pushes raw events, the drain thread converts and appends them
+    bool startGlobalKeyListener();
+    void stopGlobalKeyListener();
+    uint16_t resolveKeyId(uint16_t code) const;
+    void appendRecordedEvents(const KeyEvent* events, size_t count);
+
+    // Queues the run on the worker unless playback was stopped or restarted since startId was issued
+    void dispatchPlayback(quint64 startId, const SequenceSnapshot& snapshot, int repeatCount);
+
+    // Speed from the UI plus compression rules from settings
+    PlaybackTiming currentPlaybackTiming() const;
+    RealtimeOptions currentRealtimeOptions() const;
+
+    // Background file I/O: one request at a time, with progress in the status label
+    bool fileOperationBusy(const QString& title);
+    void beginFileOperation(const QString& verb, const QString& fileName);
+    void endFileOperation();
+
+    // Crash-safe journal of the recording in progress, kept until the sequence is saved
+    std::filesystem::path journalPath() const;
+    void discardJournal();
+
+    static constexpr int kRefreshIntervalMs = 16;  // About one refresh per 60 Hz frame
+    // Brings the timeline up to the list model: appends new events, rebuilds after a clear
+    void syncTimeline();
+
     bool recording;
     bool playing;
-    std::vector<KeyEvent> sequence;
-    mutable QMutex sequenceMutex;  // Protects sequence vector from concurrent access
-    std::chrono::high_resolution_clock::time_point lastEventTime;
+    bool playbackPaused = false;  // Pause pressed and not yet resumed; reset when playback ends
+    KeySequence sequence;  // Thread-safe copy-on-write store; readers take snapshots
+    RecordingJournal journal;  // Fed by the recorder's drain thread; declared first so it outlives keyRecorder
+    KeyRecorder keyRecorder;
+    std::unique_ptr<InputSource> inputSource;  // Hook, event tap or evdev; declared after keyRecorder so it is destroyed first
+    qint64 lastWorstLatenessUs = 0;  // Reported by the worker at the end of each run
+    quint64 lastPassCount = 0;       // Passes completed in the current or last run
+    quint64 lastMissedDeadlines = 0; // Reported with lastWorstLatenessUs
+    quint64 lastSendFailures = 0;    // Events the backend rejected, reported with lastWorstLatenessUs
 
 
     QThread* playbackThread = nullptr;
     PlaybackWorker* playbackWorker = nullptr;
+    quint64 playbackStartId = 0;  // Bumped by every start and stop; a deferred start checks it
+
+    QThread* ioThread = nullptr;
+    SequenceIoWorker* ioWorker = nullptr;
+    quint64 ioRequest = 0;        // Id of the latest request; stale signals are ignored
+    bool ioBusy = false;
+    QString ioStatus;             // "Loading name", shown with the percentage
+    QAction* cancelIoAction = nullptr;
 
     // UI elements for status display
     QLabel* statusLabel = nullptr;
     QSpinBox* repeatCountSpinner = nullptr;
-
-    // Sequence details panel
-    QTextEdit* sequenceTextEdit = nullptr;
+    QPushButton* pauseButton = nullptr;
+    QSpinBox* repeatGapSpinner = nullptr;
+    QDoubleSpinBox* speedSpinner = nullptr;
+
+    // Sequence details panel: a virtualized list plus running totals
+    QFrame* sequencePanel = nullptr;
+    QListView* sequenceView = nullptr;
+    QLabel* sequenceSummaryLabel = nullptr;
+    SequenceListModel* sequenceModel = nullptr;
+    TimelineWidget* timelineWidget = nullptr;
+    uint64_t timelineEpoch = 0;  // Sequence epoch of the events in the timeline
+    // Polls sequence.revision() once per frame while recording, so refreshes are
+    // coalesced on the GUI thread however fast keys arrive
+    QTimer* sequenceRefreshTimer = nullptr;
+    uint64_t shownSequenceRevision = 0;
     QPushButton* expandButton = nullptr;
     QPropertyAnimation* sequencePanelAnimation = nullptr;
     bool sequencePanelVisible = false;
-    int sequencePanelExpandedHeight = 180;
+    int sequencePanelExpandedHeight = 320;
 
     // Notes panel
     QPushButton* notesToggleButton = nullptr;
@@ -152,10 +199,6 @@ private:
     // For "Always on Top" feature
     bool alwaysOnTop;
     bool suppressFocusGuard = false;
-
-#if defined(__APPLE__)
-    // void recordKeyEvent(CGKeyCode keyCode, bool isPress); // Moved to public
-#endif
 };
 
 #endif // CONTROLLERAPP_H 
@@ -0,0 +1,63 @@
+#ifndef EVDEVCAPTURE_H
+#define EVDEVCAPTURE_H
+
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include "inputbackend.h"
+
+// Linux recording backend: reads every keyboard under /dev/input through epoll on a
+// dedicated capture thread, independent of the Qt event loop.
+// Events carry the kernel's CLOCK_MONOTONIC timestamp (EVIOCSCLOCKID), and keyboards
+// plugged in or removed while capturing are picked up through inotify. After the kernel
+// drops events (SYN_DROPPED) the key state is read back and the differences are reported,
+// so a lost key-up never leaves a key held in the recording.
+class EvdevCapture : public InputSource {
+public:
+    EvdevCapture() = default;
+    ~EvdevCapture() override;
+
+    EvdevCapture(const EvdevCapture&) = delete;
+    EvdevCapture& operator=(const EvdevCapture&) = delete;
+
+    // Returns false (and fills error) if no keyboard could be opened.
+    // The callback runs on the capture thread.
+    bool start(KeyCallback callback, std::string* error = nullptr) override;
+    void stop() override;
+    bool isRunning() const override { return m_thread.joinable(); }
+
+    // Number of keyboards currently being read
+    size_t deviceCount() const { return m_deviceCount.load(std::memory_order_relaxed); }
+
+private:
+    // Enough bits for every key code evdev reports
+    static constexpr size_t kKeyCount = 0x300;
+
+    struct Device {
+        std::string path;                 // /dev/input/event*
+        std::bitset<kKeyCount> keysDown;  // As last reported through the callback
+        bool dropping = false;            // After SYN_DROPPED, until the next SYN_REPORT
+    };
+
+    void captureLoop();
+    void scanDevices();
+    bool addDevice(const std::string& path);
+    void removeDevice(int fd);
+    void readDevice(int fd);
+    // Reports keys whose state changed while events were being dropped
+    void resyncDevice(int fd, Device& device, int64_t timestampNs);
+    void handleInotify();
+
+    KeyCallback m_callback;
+    std::thread m_thread;
+    int m_epollFd = -1;
+    int m_inotifyFd = -1;
+    int m_wakeFd = -1;
+    std::map<int, Device> m_devices; // By fd; capture thread only after start
+    std::atomic<size_t> m_deviceCount{0};
+};
+
+#endif // EVDEVCAPTURE_H
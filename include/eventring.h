@@ -0,0 +1,86 @@
+#ifndef EVENTRING_H
+#define EVENTRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Raw capture record pushed by the OS keyboard hook.
+// Kept trivially copyable and free of strings so the hook never allocates.
+struct RawKeyEvent {
+    int64_t timestampNs; // Monotonic capture time
+    uint16_t code;       // Platform key code
+    bool down;
+};
+
+// Wait-free single-producer/single-consumer ring buffer.
+// push() is only called from the producer (the OS hook), popBatch() only from the
+// consumer (the drain thread). When the ring is full the event is dropped and counted
+// rather than blocking the producer.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool push(const T& item) noexcept {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail >= Capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+
+        // Only the producer writes the watermark, so a plain load/store pair is enough
+        const size_t used = head + 1 - tail;
+        if (used > m_highWatermark.load(std::memory_order_relaxed)) {
+            m_highWatermark.store(used, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Moves up to maxItems entries into out and returns how many were taken
+    size_t popBatch(T* out, size_t maxItems) noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        size_t count = head - tail;
+        if (count > maxItems) {
+            count = maxItems;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = m_items[(tail + i) & (Capacity - 1)];
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t size() const noexcept {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() noexcept { return Capacity; }
+    uint64_t droppedCount() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+    size_t highWatermark() const noexcept { return m_highWatermark.load(std::memory_order_relaxed); }
+
+    // Only call while the producer is idle (e.g. before a recording starts)
+    void resetStats() noexcept {
+        m_dropped.store(0, std::memory_order_relaxed);
+        m_highWatermark.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // Producer and consumer indices live on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) std::atomic<uint64_t> m_dropped{0};
+    std::atomic<size_t> m_highWatermark{0};
+    std::array<T, Capacity> m_items{};
+};
+
+using RawEventRing = SpscRing<RawKeyEvent, 8192>;
+
+#endif // EVENTRING_H
@@ -0,0 +1,83 @@
+#ifndef INPUTBACKEND_H
+#define INPUTBACKEND_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "keyevent.h"
+
+// Where recorded keystrokes come from: the Windows low-level hook, the macOS event tap,
+// evdev on Linux, or anything else that can report key presses with a timestamp.
+class InputSource {
+public:
+    // Called for each press/release, on whatever thread the source delivers events.
+    // Timestamps are nanoseconds on the steady_clock timeline.
+    using KeyCallback = std::function<void(uint16_t code, bool isPress, int64_t timestampNs)>;
+
+    virtual ~InputSource() = default;
+
+    // Returns false (and fills error if given) when capture could not be started
+    virtual bool start(KeyCallback callback, std::string* error = nullptr) = 0;
+    virtual void stop() = 0;
+    virtual bool isRunning() const = 0;
+};
+
+// Where played-back keystrokes go: SendInput, CGEventPost, uinput, or memory.
+class InputSink {
+public:
+    virtual ~InputSink() = default;
+
+    // Acquire and release per-session resources (event source, virtual device)
+    virtual bool open(std::string* error = nullptr) { (void)error; return true; }
+    virtual void close() {}
+
+    // Time after open() before injected events reach applications. A new uinput device is
+    // only read once the compositor or X server has opened it; PlaybackEngine holds the
+    // first event back by at least this much.
+    virtual std::chrono::microseconds settleTime() const { return std::chrono::microseconds(0); }
+
+    // Injects one event; called on the playback thread
+    virtual bool send(const KeyEvent& event) = 0;
+
+    // Injects events that are due together. Backends override this to hand the whole
+    // batch to the OS in one call; the default sends them one by one.
+    virtual bool sendBatch(const KeyEvent* events, size_t count) {
+        bool ok = true;
+        for (size_t i = 0; i < count; ++i) {
+            ok = send(events[i]) && ok;
+        }
+        return ok;
+    }
+
+    // Converts the sequence to native input records once, before the timed loop.
+    // The events must stay alive until close(). The default keeps a pointer and
+    // sends through sendBatch.
+    virtual bool prepare(const KeyEvent* events, size_t count) {
+        m_preparedEvents = events;
+        m_preparedCount = count;
+        return true;
+    }
+
+    // Injects prepared events [first, first + count) in one backend call
+    virtual bool sendPrepared(size_t first, size_t count) {
+        if (!m_preparedEvents || first + count > m_preparedCount) {
+            return false;
+        }
+        return sendBatch(m_preparedEvents + first, count);
+    }
+
+    virtual const char* name() const = 0;
+
+protected:
+    const KeyEvent* m_preparedEvents = nullptr;
+    size_t m_preparedCount = 0;
+};
+
+// Backends for the platform being built; nullptr where none exists
+std::unique_ptr<InputSource> createPlatformSource();
+std::unique_ptr<InputSink> createPlatformSink();
+
+#endif // INPUTBACKEND_H
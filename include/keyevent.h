@@ -0,0 +1,52 @@
+#ifndef KEYEVENT_H
+#define KEYEVENT_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Packed keystroke record (8 bytes).
+// Key names are interned through KeyNames and only resolved back to strings when a
+// sequence is displayed or serialized, so the record and playback paths never touch
+// std::string or compare state text.
+struct KeyEvent {
+    uint32_t delayUs;   // Microseconds since the previous event
+    uint16_t keyId;     // Interned key name, see KeyNames
+    uint16_t code : 15; // Platform key code (virtual-key code on Windows, CGKeyCode on macOS)
+    uint16_t down : 1;  // 1 for key down, 0 for key up
+
+    KeyEvent() : delayUs(0), keyId(0), code(0), down(0) {}
+    KeyEvent(uint16_t id, uint16_t keyCode, bool isDown, uint32_t delayMicros)
+        : delayUs(delayMicros), keyId(id), code(keyCode & 0x7FFF), down(isDown ? 1 : 0) {}
+
+    bool isDown() const { return down != 0; }
+    std::chrono::microseconds delay() const { return std::chrono::microseconds(delayUs); }
+
+    // Saturating conversion for gaps that do not fit in 32 bits (~71 minutes)
+    static uint32_t clampDelayUs(long long us) {
+        if (us < 0) return 0;
+        if (us > static_cast<long long>(UINT32_MAX)) return UINT32_MAX;
+        return static_cast<uint32_t>(us);
+    }
+
+    static const char* stateName(bool isDown) { return isDown ? "down" : "up"; }
+};
+
+static_assert(sizeof(KeyEvent) == 8, "KeyEvent is expected to pack into 8 bytes");
+
+// Process-wide key name interner.
+// Id 0 is reserved for "Unknown". Names from the platform key table map to fixed ids
+// without locking; other names take a lock, so interning belongs on the load/record
+// bookkeeping side, never inside the timed playback loop.
+class KeyNames {
+public:
+    static constexpr uint16_t kUnknown = 0;
+
+    // Returns the id for the name, assigning a new one on first use
+    static uint16_t intern(const std::string& name);
+
+    // Returns the name for an id, or "Unknown" for ids that were never assigned
+    static std::string name(uint16_t id);
+};
+
+#endif // KEYEVENT_H
@@ -0,0 +1,69 @@
+#ifndef KEYRECORDER_H
+#define KEYRECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include "eventring.h"
+#include "keyevent.h"
+
+// Moves captured keystrokes out of the OS hook.
+// The hook only calls push(), which timestamps the event and stores it in a wait-free
+// ring. A drain thread converts the raw codes to KeyEvents (name lookup, delay
+// computation) and hands them to the sink in batches.
+class KeyRecorder {
+public:
+    // Maps a platform key code to an interned key id (KeyNames::kUnknown to skip it)
+    using KeyResolver = std::function<uint16_t(uint16_t code)>;
+    // Receives converted events; called on the drain thread
+    using EventSink = std::function<void(const KeyEvent* events, size_t count)>;
+
+    KeyRecorder() = default;
+    ~KeyRecorder();
+
+    KeyRecorder(const KeyRecorder&) = delete;
+    KeyRecorder& operator=(const KeyRecorder&) = delete;
+
+    void start(KeyResolver resolver, EventSink sink);
+    // Stops the drain thread after flushing everything already in the ring
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Hook-side entry points: wait-free, no allocation, no locks.
+    // Timestamps are nanoseconds on the steady_clock timeline (CLOCK_MONOTONIC on Linux,
+    // mach absolute time on macOS, QueryPerformanceCounter on Windows).
+    void pushAt(uint16_t code, bool isPress, int64_t timestampNs) noexcept {
+        m_ring.push(RawKeyEvent{timestampNs, code, isPress});
+    }
+
+    // For hooks whose OS event carries no usable timestamp: stamp it on arrival
+    void push(uint16_t code, bool isPress) noexcept {
+        pushAt(code, isPress, nowNs());
+    }
+
+    static int64_t nowNs() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    uint64_t droppedEvents() const { return m_ring.droppedCount(); }
+    size_t highWatermark() const { return m_ring.highWatermark(); }
+    static constexpr size_t ringCapacity() { return RawEventRing::capacity(); }
+
+private:
+    void drainLoop();
+    size_t drainOnce();
+
+    RawEventRing m_ring;
+    std::thread m_drainThread;
+    std::atomic<bool> m_running{false};
+    KeyResolver m_resolver;
+    EventSink m_sink;
+    std::unordered_map<uint16_t, uint16_t> m_keyIdCache; // Drain thread only
+    int64_t m_lastTimestampNs = 0;
+};
+
+#endif // KEYRECORDER_H
@@ -0,0 +1,54 @@
+#ifndef KEYSEQUENCE_H
+#define KEYSEQUENCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "keyevent.h"
+
+// Immutable view of a sequence. Copying one is a reference-count bump, so it can be
+// handed to the playback thread, the serializer or the view without copying events.
+using SequenceSnapshot = std::shared_ptr<const std::vector<KeyEvent>>;
+
+// Thread-safe, copy-on-write sequence store.
+// Readers take O(1) snapshots; writers mutate in place while nobody holds a snapshot
+// and clone the event buffer only when one is still alive.
+class KeySequence {
+public:
+    KeySequence();
+
+    SequenceSnapshot snapshot() const;
+
+    void append(const KeyEvent* events, size_t count);
+    void clear();
+    // Replaces the contents wholesale (used when loading a file)
+    void assign(std::vector<KeyEvent>&& events);
+
+    bool empty() const;
+    size_t size() const;
+
+    // Bumped by clear() and assign(), never by append(), so an incremental reader can
+    // tell new events from a replaced sequence
+    uint64_t epoch() const;
+    // Appends events [first, size()) to *out without taking a snapshot (so the writer never
+    // has to clone the buffer on our behalf) and returns the epoch they belong to
+    uint64_t copyTail(size_t first, std::vector<KeyEvent>* out) const;
+
+    // Bumped by every change. Lock-free, so the GUI can poll it each frame without ever
+    // contending with the recorder for m_mutex.
+    uint64_t revision() const { return m_revision.load(std::memory_order_acquire); }
+
+private:
+    // Returns a buffer that no snapshot refers to; caller must hold m_mutex
+    std::vector<KeyEvent>& detach();
+
+    mutable std::mutex m_mutex;
+    std::shared_ptr<std::vector<KeyEvent>> m_events;
+    uint64_t m_epoch = 0;
+    std::atomic<uint64_t> m_revision{0};
+};
+
+#endif // KEYSEQUENCE_H
@@ -0,0 +1,183 @@
+#ifndef KEYTABLE_H
+#define KEYTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// One row of a platform key table. Aliases resolve name -> code but are never
+// returned for code -> name (e.g. "\n" and "Enter" both map to the Return key).
+struct KeyTableEntry {
+    uint16_t code;
+    std::string_view name;
+    bool alias = false;
+};
+
+namespace keytable_detail {
+
+// FNV-1a with a seed folded into the offset basis, followed by a final avalanche
+constexpr uint32_t hashName(std::string_view name, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+constexpr size_t nextPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace keytable_detail
+
+// Bidirectional key lookup table built entirely at compile time.
+// code -> name is a dense array indexed by the key code; name -> code is a two-level
+// hash-and-displace perfect hash, so both directions are O(1) with no static-init cost.
+template <size_t N, size_t CodeSpace>
+class KeyTable {
+public:
+    static constexpr size_t kSlots = keytable_detail::nextPowerOfTwo(N * 2);
+    static constexpr size_t kBuckets = (N + 1) / 2;
+    static constexpr int16_t kEmpty = -1;
+
+    constexpr explicit KeyTable(const KeyTableEntry (&entries)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            m_entries[i] = entries[i];
+        }
+        buildCodeIndex();
+        buildPerfectHash();
+    }
+
+    static constexpr size_t size() { return N; }
+    constexpr const KeyTableEntry& entry(size_t index) const { return m_entries[index]; }
+
+    // Returns the entry index for a code, or -1 if the code is not in the table
+    constexpr int indexForCode(uint16_t code) const {
+        return (code < CodeSpace) ? m_codeIndex[code] : kEmpty;
+    }
+
+    // Returns the entry index for a name, or -1 if the name is not in the table
+    constexpr int indexForName(std::string_view name) const {
+        const uint32_t bucket = keytable_detail::hashName(name, 0) % kBuckets;
+        const uint32_t slot = keytable_detail::hashName(name, m_seeds[bucket]) & (kSlots - 1);
+        const int16_t index = m_slots[slot];
+        return (index != kEmpty && m_entries[index].name == name) ? index : kEmpty;
+    }
+
+    constexpr std::string_view name(uint16_t code) const {
+        const int index = indexForCode(code);
+        return (index == kEmpty) ? std::string_view() : m_entries[index].name;
+    }
+
+    constexpr int code(std::string_view name) const {
+        const int index = indexForName(name);
+        return (index == kEmpty) ? -1 : m_entries[index].code;
+    }
+
+private:
+    constexpr void buildCodeIndex() {
+        for (size_t c = 0; c < CodeSpace; ++c) {
+            m_codeIndex[c] = kEmpty;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            if (m_entries[i].code >= CodeSpace) {
+                throw "KeyTable: key code outside of CodeSpace";
+            }
+            // First non-alias entry wins, matching the order of the source table
+            if (!m_entries[i].alias && m_codeIndex[m_entries[i].code] == kEmpty) {
+                m_codeIndex[m_entries[i].code] = static_cast<int16_t>(i);
+            }
+        }
+    }
+
+    constexpr void buildPerfectHash() {
+        // First level: distribute names into buckets
+        size_t bucketOf[N] = {};
+        size_t bucketSize[kBuckets] = {};
+        for (size_t i = 0; i < N; ++i) {
+            bucketOf[i] = keytable_detail::hashName(m_entries[i].name, 0) % kBuckets;
+            ++bucketSize[bucketOf[i]];
+        }
+
+        // Identical names would always collide, so reject them up front
+        for (size_t i = 0; i < N; ++i) {
+            if (m_entries[i].name.empty()) {
+                throw "KeyTable: empty key name";
+            }
+            for (size_t j = i + 1; j < N; ++j) {
+                if (m_entries[i].name == m_entries[j].name) {
+                    throw "KeyTable: duplicate key name";
+                }
+            }
+        }
+
+        for (size_t s = 0; s < kSlots; ++s) {
+            m_slots[s] = kEmpty;
+        }
+
+        // Place the largest buckets first; each bucket searches for a seed that sends
+        // all of its names to distinct free slots
+        bool placed[kBuckets] = {};
+        for (size_t round = 0; round < kBuckets; ++round) {
+            size_t bucket = kBuckets;
+            for (size_t b = 0; b < kBuckets; ++b) {
+                if (!placed[b] && (bucket == kBuckets || bucketSize[b] > bucketSize[bucket])) {
+                    bucket = b;
+                }
+            }
+            placed[bucket] = true;
+            m_seeds[bucket] = 0;
+            if (bucketSize[bucket] == 0) {
+                continue;
+            }
+
+            for (uint32_t seed = 1;; ++seed) {
+                if (seed > 1000000) {
+                    throw "KeyTable: no perfect hash seed found";
+                }
+
+                size_t slots[N] = {};
+                size_t count = 0;
+                bool fits = true;
+                for (size_t i = 0; i < N && fits; ++i) {
+                    if (bucketOf[i] != bucket) {
+                        continue;
+                    }
+                    const size_t slot = keytable_detail::hashName(m_entries[i].name, seed) & (kSlots - 1);
+                    fits = (m_slots[slot] == kEmpty);
+                    for (size_t k = 0; k < count && fits; ++k) {
+                        fits = (slots[k] != slot);
+                    }
+                    slots[count++] = slot;
+                }
+                if (!fits) {
+                    continue;
+                }
+
+                count = 0;
+                for (size_t i = 0; i < N; ++i) {
+                    if (bucketOf[i] == bucket) {
+                        m_slots[slots[count++]] = static_cast<int16_t>(i);
+                    }
+                }
+                m_seeds[bucket] = seed;
+                break;
+            }
+        }
+    }
+
+    KeyTableEntry m_entries[N] = {};
+    int16_t m_codeIndex[CodeSpace] = {};
+    uint32_t m_seeds[kBuckets] = {};
+    int16_t m_slots[kSlots] = {};
+};
+
+#endif // KEYTABLE_H
@@ -0,0 +1,26 @@
+#ifndef KEYTABLES_H
+#define KEYTABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "keytable.h"
+
+// Lookups into this platform's compile-time key table
+// (virtual-key codes on Windows, CGKeyCodes on macOS, evdev KEY_* codes on Linux).
+namespace KeyTables {
+
+// Canonical name for a code, or an empty view if the code is not in the table
+std::string_view nameForCode(uint16_t code);
+
+// Code for a canonical name or alias, or -1 if the name is not in the table
+int codeForName(std::string_view name);
+
+// Entry-level access, used to give table names stable interned ids
+size_t size();
+int indexForName(std::string_view name);
+const KeyTableEntry& entry(size_t index);
+
+} // namespace KeyTables
+
+#endif // KEYTABLES_H
@@ -0,0 +1,41 @@
+#ifndef LOOPBACKSINK_H
+#define LOOPBACKSINK_H
+
+#include <cstdint>
+#include <vector>
+#include "inputbackend.h"
+
+// Records what would have been injected, with the steady_clock time of each send.
+// Lets playback run headless (CI, benchmarks) without touching the OS input queue.
+// With recording off it only counts sends, so a run that loops until stopped stays in
+// constant memory.
+class LoopbackSink : public InputSink {
+public:
+    struct Injected {
+        KeyEvent event;
+        int64_t timestampNs;
+    };
+
+    explicit LoopbackSink(size_t expectedEvents = 0, bool recordEvents = true);
+
+    bool send(const KeyEvent& event) override { return sendBatch(&event, 1); }
+    // Every event in a batch gets the same timestamp, as it would from a single OS call
+    bool sendBatch(const KeyEvent* events, size_t count) override;
+    const char* name() const override { return "loopback"; }
+
+    // Reserve up front so send() never reallocates mid-playback
+    void reserve(size_t expectedEvents) { m_events.reserve(expectedEvents); }
+    void clear() { m_events.clear(); m_sentCount = 0; }
+
+    // Only read once playback has finished. Empty when recording is off.
+    const std::vector<Injected>& events() const { return m_events; }
+    // Events sent since construction or clear(), recorded or not
+    uint64_t sentCount() const { return m_sentCount; }
+
+private:
+    std::vector<Injected> m_events;
+    uint64_t m_sentCount = 0;
+    bool m_recordEvents;
+};
+
+#endif // LOOPBACKSINK_H
@@ -0,0 +1,54 @@
+#ifndef PLAYBACKCLOCK_H
+#define PLAYBACKCLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Absolute-deadline timer used by the playback loop.
+// Each event is scheduled against a fixed origin taken from a steady clock, so
+// oversleep on one event is absorbed by the next one instead of accumulating.
+class PlaybackClock {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    // Default window before a deadline in which we busy-wait instead of sleeping
+    static constexpr std::chrono::microseconds kDefaultSpinThreshold{500};
+    // Lateness beyond this counts as a missed deadline
+    static constexpr std::chrono::microseconds kMissTolerance{1000};
+
+    PlaybackClock() = default;
+
+    // Thread-safe: may be changed from the GUI thread while playback runs
+    void setSpinThreshold(std::chrono::microseconds threshold);
+    std::chrono::microseconds spinThreshold() const;
+
+    // Coarse sleep until (deadline - spinThreshold), then spin until the deadline.
+    // Returns false if interrupt() was called before the deadline was reached.
+    bool sleepUntil(TimePoint deadline);
+
+    // Wakes any pending sleepUntil() immediately; it stays interrupted until cleared.
+    // Safe to call from any thread.
+    void interrupt();
+    void clearInterrupt();
+    bool isInterrupted() const { return m_interrupted.load(std::memory_order_acquire); }
+
+    // Lateness bookkeeping for one run
+    void resetStats();
+    void recordLateness(TimePoint deadline, TimePoint actual);
+    std::chrono::microseconds worstLateness() const { return m_worstLateness; }
+    size_t missedDeadlines() const { return m_missedDeadlines; }
+
+private:
+    std::atomic<long long> m_spinThresholdUs{kDefaultSpinThreshold.count()};
+    std::atomic<bool> m_interrupted{false};
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCondition;
+    std::chrono::microseconds m_worstLateness{0};
+    size_t m_missedDeadlines = 0;
+};
+
+#endif // PLAYBACKCLOCK_H
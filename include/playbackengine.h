@@ -0,0 +1,158 @@
+#ifndef PLAYBACKENGINE_H
+#define PLAYBACKENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "inputbackend.h"
+#include "keyevent.h"
+#include "playbackclock.h"
+#include "playbacktape.h"
+#include "realtimethread.h"
+
+// Replays a sequence into an InputSink on the calling thread.
+// Free of Qt and OS injection code so it can run headless against a LoopbackSink.
+// Each run compiles the sequence into a PlaybackTape and lets the sink prepare its native
+// records first; the timed loop then only waits and sends.
+class PlaybackEngine {
+public:
+    struct Report {
+        PlaybackClock::TimePoint origin;  // Schedule origin; the first deadline is origin + preroll + delay
+        std::chrono::microseconds preroll{0};  // As applied: the setting, or the sink's settle time if longer
+        std::chrono::microseconds worstLateness{0};
+        size_t eventsSent = 0;
+        size_t sendFailures = 0;
+        size_t batches = 0;       // Backend calls; eventsSent / batches is the mean batch size
+        uint64_t passes = 0;      // Passes played to the end
+        size_t missedDeadlines = 0;  // Batches later than PlaybackClock::kMissTolerance
+        std::string threadMode;      // Scheduling the run actually got, see RealtimeScope::mode()
+        std::string threadWarnings;  // Low-latency steps that were not permitted
+        int64_t passDurationUs = 0;  // One pass after timing rules were applied
+        bool completed = false;  // False if stop() cut the run short
+    };
+
+    static constexpr std::chrono::milliseconds kDefaultPreroll{300};
+    static constexpr std::chrono::milliseconds kDefaultRepeatGap{500};
+    // Repeat count for run() that loops until stop() is called
+    static constexpr int kRepeatForever = 0;
+
+    // Called on the playback thread at the end of every pass with the passes completed
+    // so far. Runs inside the timed loop, so it must return quickly.
+    using PassCallback = std::function<void(uint64_t passesCompleted)>;
+    // Events due within this window of a batch's first deadline are injected with it
+    static constexpr std::chrono::microseconds kDefaultBatchThreshold{1000};
+    static constexpr size_t kMaxBatchSize = 64;
+
+    PlaybackEngine() = default;
+
+    // Window before each deadline spent spinning instead of sleeping (thread-safe)
+    void setSpinThreshold(std::chrono::microseconds threshold) { m_clock.setSpinThreshold(threshold); }
+    std::chrono::microseconds spinThreshold() const { return m_clock.spinThreshold(); }
+
+    // Batching window for near-simultaneous events (thread-safe); zero batches only
+    // events with no delay between them
+    void setBatchThreshold(std::chrono::microseconds threshold) { m_batchThresholdUs = threshold.count(); }
+    std::chrono::microseconds batchThreshold() const { return std::chrono::microseconds(m_batchThresholdUs.load()); }
+
+    // Speed and gap-compression rules for the next run (thread-safe)
+    void setTiming(const PlaybackTiming& timing);
+    PlaybackTiming timing() const;
+
+    // Delay before the first event, giving the target application time to take focus (thread-safe).
+    // Runs wait at least the sink's settleTime() whatever this is set to.
+    void setPreroll(std::chrono::microseconds preroll) { m_prerollUs = preroll.count(); }
+
+    // Time from the last event of one pass to the first event of the next (thread-safe).
+    // Zero starts the next pass on the instant the previous one ends.
+    void setRepeatGap(std::chrono::microseconds gap) { m_repeatGapUs = gap.count(); }
+    std::chrono::microseconds repeatGap() const { return std::chrono::microseconds(m_repeatGapUs.load()); }
+
+    // Low-latency thread mode for the next run (thread-safe). Applied to the thread that
+    // calls run() once the tape is compiled, and undone when run() returns.
+    void setRealtime(const RealtimeOptions& options);
+    RealtimeOptions realtime() const;
+
+    // Not thread-safe: set before run()
+    void setPassCallback(PassCallback callback) { m_passCallback = std::move(callback); }
+
+    // Blocks until the sequence has been played repeatCount times or stop() is called;
+    // kRepeatForever (or any count <= 0) plays until stop().
+    // The first pass starts at startEvent, with the keys held at that point pressed first.
+    Report run(const std::vector<KeyEvent>& events, int repeatCount, InputSink& sink, size_t startEvent = 0);
+
+    // Thread-safe: marks the engine running before run() is handed to another thread, so a
+    // stop() that arrives before run() starts still ends that run at once, and a pause or
+    // seek is applied from its first event. A run() without a preceding arm() starts
+    // regardless of earlier control calls.
+    void arm();
+    // Thread-safe: drops an arm() whose run() will not happen after all
+    void disarm();
+
+    // Thread-safe: wakes a pending wait and ends the current or armed run. Held keys are released.
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Thread-safe playback control. Pausing releases held keys and resuming presses them
+    // again; the rest of the schedule shifts by the time spent paused.
+    void pause();
+    void resume();
+    bool isPaused() const { return m_paused.load(std::memory_order_acquire); }
+
+    // Thread-safe: jump within the current pass, by event index or by offset from the
+    // start of the pass (timing rules applied). Held keys are synced to the new position.
+    // A target at or past the end finishes the pass, then repeats or ends the run as usual.
+    void seekToEvent(size_t eventIndex);
+    void seekToTime(std::chrono::microseconds offset);
+
+    // Index of the next event to be sent in the current pass
+    size_t position() const { return m_position.load(std::memory_order_relaxed); }
+    // Passes played to the end in the current run
+    uint64_t passesCompleted() const { return m_passesCompleted.load(std::memory_order_relaxed); }
+
+private:
+    // Per-run state shared by the loop and the control handlers
+    struct RunState {
+        const std::vector<KeyEvent>& events;
+        const PlaybackTape& tape;
+        InputSink& sink;
+        PlaybackClock::TimePoint passStart;
+        size_t nextEvent = 0;
+        HeldKeySet held;  // Keys the schedule says are down at nextEvent
+    };
+
+    // Handles pause/seek requests after the clock was interrupted; false means stop
+    bool handleControl(RunState& state);
+    void seekTo(RunState& state, size_t target, int64_t offsetUs, bool keysLive);
+    void sendKeyChanges(RunState& state, const HeldKeySet& keys, bool isDown);
+
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_armed{false};  // Set by arm(), consumed by the next run()
+    std::atomic<bool> m_paused{false};
+    std::atomic<size_t> m_position{0};
+    std::atomic<uint64_t> m_passesCompleted{0};
+    std::atomic<long long> m_batchThresholdUs{kDefaultBatchThreshold.count()};
+    std::atomic<long long> m_prerollUs{std::chrono::microseconds(kDefaultPreroll).count()};
+    std::atomic<long long> m_repeatGapUs{std::chrono::microseconds(kDefaultRepeatGap).count()};
+    PassCallback m_passCallback;
+    PlaybackClock m_clock;
+    mutable std::mutex m_timingMutex;
+    PlaybackTiming m_timing;
+    RealtimeOptions m_realtime;
+
+    // Control requests, guarded by m_controlMutex
+    std::mutex m_controlMutex;
+    std::condition_variable m_controlCondition;
+    bool m_pauseRequested = false;
+    bool m_seekRequested = false;
+    bool m_seekByIndex = false;
+    size_t m_seekEvent = 0;
+    int64_t m_seekOffsetUs = 0;
+};
+
+#endif // PLAYBACKENGINE_H
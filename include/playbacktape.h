@@ -0,0 +1,62 @@
+#ifndef PLAYBACKTAPE_H
+#define PLAYBACKTAPE_H
+
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "keyevent.h"
+
+// Timing rules applied while a tape is compiled, so the recording itself is never edited.
+// Gap rules look at the recorded gaps, speed then scales the result, and the hold rule
+// is enforced last on the final timeline.
+struct PlaybackTiming {
+    double speed = 1.0;           // 2.0 plays twice as fast; values <= 0 mean 1.0
+    int64_t maxGapUs = 0;         // Cap on any single gap; 0 = off
+    int64_t idleThresholdUs = 0;  // Gaps longer than this count as idle; 0 = off
+    int64_t idleGapUs = 0;        // What an idle gap collapses to
+    int64_t minHoldUs = 0;        // Minimum time from a key's down to its up; 0 = off
+
+    bool isIdentity() const {
+        return (speed <= 0.0 || speed == 1.0) && maxGapUs <= 0 && idleThresholdUs <= 0 && minHoldUs <= 0;
+    }
+};
+
+// One bit per key code (KeyEvent::code is 15 bits)
+using HeldKeySet = std::bitset<1u << 15>;
+
+// A sequence compiled for playback: batches of events with their offsets from the start
+// of a pass already resolved. Built once before the timed loop so the loop itself only
+// waits for the next offset and hands a prepared batch to the sink.
+struct PlaybackTape {
+    struct Batch {
+        int64_t offsetUs;  // From the start of the pass
+        uint32_t first;    // Index of the first event in the source sequence
+        uint32_t count;
+    };
+
+    std::vector<Batch> batches;
+    std::vector<int64_t> eventOffsetsUs;  // Scheduled offset of every event, non-decreasing
+    int64_t durationUs = 0;               // Offset of the last event
+    size_t eventCount = 0;
+
+    // Keys held just before event k * kCheckpointInterval, so the held set at any
+    // position is rebuilt from the nearest checkpoint instead of from the start
+    static constexpr size_t kCheckpointInterval = 256;
+    std::vector<std::vector<uint16_t>> heldCheckpoints;
+    std::unordered_map<uint16_t, uint16_t> keyIds;  // Key id seen for each code
+
+    // Seek support, O(log n) on the offset index
+    size_t eventAtOffset(int64_t offsetUs) const;      // First event at or after the offset
+    size_t batchContaining(size_t eventIndex) const;
+    HeldKeySet heldBefore(const std::vector<KeyEvent>& events, size_t eventIndex) const;
+
+    // Applies timing, then lets events due within batchThreshold of a batch's first
+    // event join that batch, up to maxBatch events per batch
+    static PlaybackTape compile(const std::vector<KeyEvent>& events, const PlaybackTiming& timing,
+                                std::chrono::microseconds batchThreshold, size_t maxBatch);
+};
+
+#endif // PLAYBACKTAPE_H
@@ -3,33 +3,60 @@
 
 #include <QObject>
 #include <QThread>
-#include <vector>
-#include <atomic>
+#include <chrono>
+#include <memory>
 #include "controllerapp.h" // For KeyEvent struct definition
+#include "inputbackend.h"
+#include "playbackengine.h"
 
-#ifdef _WIN32
-#include <windows.h>
-#elif defined(__APPLE__)
-#include <Carbon/Carbon.h> // For CGKeyCode and event functions
-#endif
-
+// Qt front end for PlaybackEngine: runs it on the worker thread and reports back via signals
 class PlaybackWorker : public QObject {
     Q_OBJECT
 
 public:
-    explicit PlaybackWorker(QObject *parent = nullptr);
+    // Uses the platform injection backend unless another sink is supplied
+    explicit PlaybackWorker(QObject *parent = nullptr, std::unique_ptr<InputSink> sink = nullptr);
+    ~PlaybackWorker() override;
+
+    // Window before each deadline spent spinning instead of sleeping (thread-safe)
+    void setSpinThreshold(std::chrono::microseconds threshold);
+    // Events due within this window of each other are injected in one backend call
+    void setBatchThreshold(std::chrono::microseconds threshold);
+    // Speed and gap-compression rules, applied when the next run compiles its tape
+    void setTiming(const PlaybackTiming& timing);
+    // Delay before the first event so the target application can take focus
+    void setPreroll(std::chrono::microseconds preroll);
+    // Low-latency thread mode (scheduling, CPU pinning, memory locking) for the next run
+    void setRealtime(const RealtimeOptions& options);
+    // Gap between the end of one pass and the start of the next; zero is allowed
+    void setRepeatGap(std::chrono::microseconds gap);
+
+    // Thread-safe playback control, callable directly from the GUI thread.
+    // armWork() goes before doWork is queued, so a stopWork() in between is not lost.
+    void armWork();
+    bool isPaused() const { return m_engine.isPaused(); }
+    size_t position() const { return m_engine.position(); }
+    void seekToEvent(size_t eventIndex);
+    void seekToTime(std::chrono::microseconds offset);
 
 public slots:
-    void doWork(const std::vector<KeyEvent>& sequence, int repeatCount = 1);
+    void doWork(const SequenceSnapshot& sequence, int repeatCount = 1);
     void stopWork();
+    void pauseWork();
+    void resumeWork();
 
 signals:
-    void finished();
+    // error is empty unless the run could not start, e.g. the injection backend failed to open
+    void finished(const QString& error);
+    void timingReport(qint64 worstLatenessUs, quint64 missedDeadlines, quint64 sendFailures);
+    // Throttled to kProgressInterval so short, endless loops do not flood the GUI thread
+    void passProgress(quint64 passesCompleted, double passesPerSecond);
 
 private:
-    void emulate_key_press(const KeyEvent& event);
+    static constexpr std::chrono::milliseconds kProgressInterval{250};
 
-    std::atomic<bool> m_running{false};
+    PlaybackEngine m_engine;
+    std::unique_ptr<InputSink> m_sink;
 };
 
-#endif // PLAYBACKWORKER_H 
\ No newline at end of file
+#endif // PLAYBACKWORKER_H 
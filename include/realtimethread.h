@@ -0,0 +1,56 @@
+#ifndef REALTIMETHREAD_H
+#define REALTIMETHREAD_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Opt-in low-latency settings for the playback thread
+struct RealtimeOptions {
+    bool enabled = false;
+    int cpu = -1;           // CPU to pin the thread to; -1 leaves affinity alone
+    int priority = 0;       // Real-time priority; 0 picks kDefaultPriority
+    bool lockMemory = true; // mlockall so the first deadlines do not take page faults
+
+    static constexpr int kDefaultPriority = 50;
+};
+
+// Applies RealtimeOptions to the calling thread for the lifetime of the object and
+// restores the previous scheduling, affinity and memory locking afterwards.
+// Each step that is not permitted (no CAP_SYS_NICE, RLIMIT_MEMLOCK, unsupported
+// platform) is skipped and noted in warnings(); playback still runs, just without it.
+class RealtimeScope {
+public:
+    explicit RealtimeScope(const RealtimeOptions& options);
+    ~RealtimeScope();
+
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+
+    bool isRealtime() const { return m_realtime; }
+    bool isPinned() const { return m_pinned; }
+    bool isMemoryLocked() const { return m_memoryLocked; }
+
+    // Short description of what was applied, e.g. "SCHED_FIFO/50 cpu2 mlock" or "normal"
+    const std::string& mode() const { return m_mode; }
+    const std::string& warnings() const { return m_warnings; }
+
+    // Touches every page of a buffer so it is resident before the timed loop starts
+    static void prefault(const void* data, size_t bytes);
+
+private:
+    void warn(const std::string& message);
+
+    bool m_realtime = false;
+    bool m_pinned = false;
+    bool m_memoryLocked = false;
+    std::string m_mode = "normal";
+    std::string m_warnings;
+
+    // Previous thread state, restored by the destructor
+    int m_oldPolicy = 0;
+    int m_oldPriority = 0;
+    std::vector<int> m_oldCpus;  // Empty if affinity was not changed
+};
+
+#endif // REALTIMETHREAD_H
@@ -0,0 +1,97 @@
+#ifndef RECORDINGJOURNAL_H
+#define RECORDINGJOURNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "keyevent.h"
+
+// Append-only, crash-safe log of a recording in progress.
+// append() only copies events into a pending buffer; a writer thread turns them into
+// checksummed blocks of up to kBlockEvents events and commits everything pending with a
+// single write and one fsync, when a block fills or kCommitInterval passes. A crash
+// loses at most the last commit interval.
+//
+// Layout, all integers little-endian:
+//   Header (24 bytes)  "CRJL", version, flags, platform, reserved, start time (Unix seconds)
+//   Blocks             "CJBK", sequence number, event count, CRC-32 of the events, then
+//                      per event: u32 delayUs, u16 key code, u16 down
+// Key ids are process-local, so only codes are stored and recover() resolves them again.
+//
+// Blocks vary in size rather than being padded to a fixed size. Each commit appends whole
+// blocks past the end of the file and never rewrites committed bytes, so a torn write can
+// only damage the blocks of the commit in flight. recover() walks the blocks in order and
+// stops at the first one whose magic, sequence number, count, length or CRC does not check
+// out. That gives the same guarantee as fixed-size blocks: every committed block before the
+// tear is recovered, and nothing after it is trusted. Fixed-size blocks would instead pad
+// every 250 ms commit to the block size, or rewrite a partial block in place and put
+// already-committed events at risk.
+class RecordingJournal {
+public:
+    using KeyResolver = std::function<uint16_t(uint16_t code)>;
+
+    static constexpr size_t kBlockEvents = 512;
+    static constexpr std::chrono::milliseconds kCommitInterval{250};
+
+    struct Recovered {
+        std::vector<KeyEvent> events;
+        int64_t startedAtUnix = 0;
+        bool tornTail = false;  // The last block was cut short or corrupt and was dropped
+    };
+
+    RecordingJournal() = default;
+    ~RecordingJournal();
+
+    RecordingJournal(const RecordingJournal&) = delete;
+    RecordingJournal& operator=(const RecordingJournal&) = delete;
+
+    // Truncates or creates the journal and starts the writer thread
+    bool open(const std::filesystem::path& path, std::string* error = nullptr);
+    // Commits whatever is pending and stops the writer; the file stays until discard()
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    // Called from the recorder's drain thread. Never waits on the disk.
+    void append(const KeyEvent* events, size_t count);
+
+    uint64_t committedEvents() const { return m_committedEvents.load(std::memory_order_relaxed); }
+    uint64_t commits() const { return m_commits.load(std::memory_order_relaxed); }
+    // Set once a write or sync fails; later events are no longer journaled
+    bool failed() const { return m_failed.load(std::memory_order_relaxed); }
+    std::string errorString() const;
+
+    // Reads every intact block of a journal left behind. Returns false if there is no
+    // journal or it holds no events.
+    static bool recover(const std::filesystem::path& path, const KeyResolver& resolver, Recovered* out);
+    // Deletes the journal once its contents are safe elsewhere
+    static void discard(const std::filesystem::path& path);
+
+private:
+    void writerLoop();
+    bool commit(std::vector<KeyEvent>& events);
+
+    std::FILE* m_file = nullptr;
+    std::thread m_writerThread;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<KeyEvent> m_pending;  // Guarded by m_mutex
+    bool m_stopping = false;          // Guarded by m_mutex
+    std::string m_error;              // Guarded by m_mutex
+
+    uint32_t m_nextBlock = 0;  // Writer thread only
+    std::vector<uint8_t> m_scratch;
+    std::atomic<uint64_t> m_committedEvents{0};
+    std::atomic<uint64_t> m_commits{0};
+    std::atomic<bool> m_failed{false};
+};
+
+#endif // RECORDINGJOURNAL_H
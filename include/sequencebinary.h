@@ -0,0 +1,88 @@
+#ifndef SEQUENCEBINARY_H
+#define SEQUENCEBINARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "keyevent.h"
+
+// Compact binary sequence format (.crft). Qt-free; SequenceFile handles the file itself.
+//
+// Layout, all integers little-endian:
+//   Header (40 bytes)  "CRFT", version, flags, counts, section sizes, platform,
+//                      total duration and a CRC-32 of the header fields before it
+//                      and everything after the header (version 1: after the header only)
+//   Dictionary         one entry per distinct (key name, key code) pair:
+//                      varint code, varint name length, UTF-8 name
+//   Events             per event: varint delayUs, then
+//                      varint((zigzag(entry - previous entry) << 1) | down)
+// A typical keystroke takes two or three bytes. Nothing in the file is trusted before the
+// checksum matches, and no count is used to size memory beyond what its section could hold.
+namespace SequenceBinary {
+
+constexpr char kMagic[4] = {'C', 'R', 'F', 'T'};
+constexpr uint16_t kVersion = 2;
+constexpr size_t kHeaderSize = 40;
+
+// Which platform's key codes the file stores
+enum class Platform : uint32_t { Unknown = 0, Windows = 1, MacOS = 2, Linux = 3 };
+Platform currentPlatform();
+
+// CRC-32 (IEEE 802.3, as used by zip and PNG); also checksums the recording journal.
+// Pass the previous result as crc to continue over data that is not contiguous.
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+struct Header {
+    uint16_t version = kVersion;
+    uint16_t flags = 0;
+    uint32_t eventCount = 0;
+    uint32_t dictionaryCount = 0;
+    uint32_t dictionaryBytes = 0;
+    uint32_t eventBytes = 0;
+    Platform platform = Platform::Unknown;
+    uint64_t durationUs = 0;  // Sum of all delays
+    uint32_t checksum = 0;    // CRC-32 of the header fields and both sections
+};
+
+// Called every kProgressStride events with events done out of total; returning false cancels
+using Progress = std::function<bool(size_t done, size_t total)>;
+constexpr size_t kProgressStride = 4096;
+
+// True if the buffer starts with the .crft magic
+bool isBinary(const uint8_t* data, size_t size);
+
+// Serializes events with this platform's codes
+std::vector<uint8_t> encode(const std::vector<KeyEvent>& events);
+
+// Reads a .crft image in place, typically a memory-mapped file. The buffer must stay
+// valid for the reader's lifetime.
+class Reader {
+public:
+    // Checks the header against the file size and the checksum, then parses the
+    // dictionary; returns false with a message on a bad file
+    bool open(const uint8_t* data, size_t size, std::string* error = nullptr);
+
+    const Header& header() const { return m_header; }
+
+    // Appends the events to *events. Codes recorded on another platform are resolved
+    // from the key name, as the JSON loader does. A cancelled decode appends nothing.
+    bool decode(std::vector<KeyEvent>* events, std::string* error = nullptr,
+                const Progress& progress = nullptr) const;
+
+private:
+    struct Entry {
+        uint16_t keyId;
+        uint16_t code;
+    };
+
+    Header m_header;
+    std::vector<Entry> m_entries;
+    const uint8_t* m_events = nullptr;
+    const uint8_t* m_sections = nullptr;
+};
+
+} // namespace SequenceBinary
+
+#endif // SEQUENCEBINARY_H
@@ -0,0 +1,40 @@
+#ifndef SEQUENCEFILE_H
+#define SEQUENCEFILE_H
+
+#include <QString>
+#include <functional>
+#include <vector>
+#include "keyevent.h"
+
+// Reading and writing sequence files, binary or JSON. Only needs QtCore, so the benchmark
+// and other non-GUI tools share the exact loader the application uses.
+namespace SequenceFile {
+
+// Compact binary format (see sequencebinary.h) or the JSON interchange format
+enum class Format { Json, Binary };
+constexpr const char* kBinarySuffix = "crft";
+
+// Key code field written and preferred on this platform ("winKeyCode", "macKeyCode", ...)
+const char* platformCodeField();
+
+// Binary for ".crft", JSON for anything else
+Format formatForFileName(const QString& fileName);
+
+// Receives the percentage done, called from the thread doing the work; returning false
+// cancels the operation
+using Progress = std::function<bool(int percent)>;
+
+// On failure or cancellation returns false and fills error with a user-facing message.
+// load() detects the format from the file contents and leaves *events untouched on failure.
+// save() picks the format from the name unless one is given, and goes through a temporary
+// file, so a failed or cancelled save never leaves a partial file behind.
+bool load(const QString& fileName, std::vector<KeyEvent>* events, QString* error = nullptr,
+          const Progress& progress = nullptr);
+bool save(const QString& fileName, const std::vector<KeyEvent>& events, QString* error = nullptr,
+          const Progress& progress = nullptr);
+bool save(const QString& fileName, const std::vector<KeyEvent>& events, Format format, QString* error = nullptr,
+          const Progress& progress = nullptr);
+
+} // namespace SequenceFile
+
+#endif // SEQUENCEFILE_H
@@ -0,0 +1,50 @@
+#ifndef SEQUENCEIOWORKER_H
+#define SEQUENCEIOWORKER_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include "keysequence.h"
+#include "timelineindex.h"
+
+// A timeline index built off the GUI thread, handed over with a finished load
+using TimelineIndexPtr = std::shared_ptr<TimelineIndex>;
+
+// Runs SequenceFile loads and saves on its own thread so large files never block the GUI.
+// A finished load is swapped into the target store in one step; until then the store,
+// and any recording or playback reading from it, is untouched.
+class SequenceIoWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SequenceIoWorker(KeySequence* target, QObject* parent = nullptr);
+
+    // Thread-safe, callable directly from the GUI thread. Cancels the request with this id,
+    // and any earlier one, at its next progress check; it is fine if it has not started yet.
+    void cancel(quint64 request);
+
+public slots:
+    // request is a caller-chosen, increasing id echoed back in the signals
+    void loadFile(quint64 request, const QString& fileName);
+    void saveFile(quint64 request, const QString& fileName, const SequenceSnapshot& snapshot);
+
+signals:
+    // Emitted only when the percentage changes
+    void progress(quint64 request, int percent);
+    // error is empty on success; a cancelled request reports cancelled and leaves everything as it was.
+    // On success, timeline indexes the loaded events so the GUI does not have to.
+    void loadFinished(quint64 request, const QString& fileName, quint64 eventCount, const QString& error,
+                      bool cancelled, const TimelineIndexPtr& timeline);
+    void saveFinished(quint64 request, const QString& fileName, const QString& error, bool cancelled);
+
+private:
+    // Progress callback for SequenceFile: reports changes and polls for cancellation
+    bool report(quint64 request, int percent, int* lastPercent);
+    bool isCancelled(quint64 request) const { return m_cancelledThrough.load() >= request; }
+
+    KeySequence* m_target;
+    std::atomic<quint64> m_cancelledThrough{0};
+};
+
+#endif // SEQUENCEIOWORKER_H
@@ -0,0 +1,41 @@
+#ifndef SEQUENCEJSON_H
+#define SEQUENCEJSON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "keyevent.h"
+
+// Streaming reader and writer for the JSON sequence schema:
+//   [ { "key": "a", "state": "down", "delay": 0, "delayUs": 120, "<platform>KeyCode": 30 }, ... ]
+// Qt-free, and no document tree is built. The reader finds quotes and structural
+// characters 64 bytes at a time with SSE2/NEON (scalar elsewhere) and converts each object
+// straight into a KeyEvent; the writer formats into a fixed buffer that is flushed as it
+// fills. Beyond the events themselves, memory use does not grow with the file.
+namespace SequenceJson {
+
+// Called every kProgressStride events with work done out of total (bytes when reading,
+// events when writing); returning false cancels
+using Progress = std::function<bool(size_t done, size_t total)>;
+constexpr size_t kProgressStride = 4096;
+constexpr const char* kCancelled = "Cancelled.";
+
+// Parses a whole file image, typically memory-mapped. codeField names the key code
+// field for this platform; events without it get their code from the key name.
+// Non-object array elements and unknown fields are skipped. On failure returns false,
+// fills error (kCancelled if progress cancelled) and leaves *events untouched.
+bool parse(const char* data, size_t size, const char* codeField,
+           std::vector<KeyEvent>* events, std::string* error = nullptr, const Progress& progress = nullptr);
+
+// Receives formatted output in chunks; returning false aborts the write
+using Output = std::function<bool(const char* data, size_t size)>;
+
+// Writes events in the same layout QJsonDocument::toJson produces (indented, keys sorted)
+bool write(const std::vector<KeyEvent>& events, const char* codeField, const Output& output,
+           const Progress& progress = nullptr);
+
+} // namespace SequenceJson
+
+#endif // SEQUENCEJSON_H
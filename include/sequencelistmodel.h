@@ -0,0 +1,42 @@
+#ifndef SEQUENCELISTMODEL_H
+#define SEQUENCELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <vector>
+#include "keyevent.h"
+#include "keysequence.h"
+
+// One row per event for the sequence details panel. The view only asks for the rows it
+// shows, and sync() copies and inserts just the events appended since the last call, so
+// refreshing during a long recording costs O(new events) instead of O(sequence).
+class SequenceListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit SequenceListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // Catches up with the store: appends new rows, or resets if it was cleared or replaced
+    void sync(const KeySequence& sequence);
+
+    // The model's own copy of the events, for views that draw the whole sequence
+    const std::vector<KeyEvent>& events() const { return m_events; }
+    // KeySequence::epoch() of the events shown; changes when the sequence is cleared or replaced
+    uint64_t epoch() const { return m_epoch; }
+
+    // Totals kept up to date by sync()
+    size_t eventCount() const { return m_events.size(); }
+    long long totalTimeUs() const { return m_totalTimeUs; }
+
+signals:
+    void totalsChanged();
+
+private:
+    std::vector<KeyEvent> m_events;
+    long long m_totalTimeUs = 0;
+    uint64_t m_epoch = 0;
+};
+
+#endif // SEQUENCELISTMODEL_H
@@ -0,0 +1,84 @@
+#ifndef TIMELINEINDEX_H
+#define TIMELINEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "keyevent.h"
+
+// Multi-resolution summary of a sequence for drawing it as a timeline, one lane per key.
+// Qt-free; TimelineWidget does the painting.
+//
+// Each lane keeps its down/up intervals plus a pyramid of buckets: level 0 splits the
+// whole sequence into at most kBaseBuckets buckets, and each level above halves the count.
+// sample() picks the level whose buckets are just narrower than a pixel column, so a
+// repaint costs O(visible columns) whatever the zoom. Only when zoomed in past level 0 does
+// it read the raw intervals, and then only the few inside the view.
+//
+// append() folds in new events in O(new events): bucket widths are powers of two, so when
+// the sequence outgrows level 0 its finest level is dropped and the next one takes over.
+class TimelineIndex {
+public:
+    static constexpr size_t kBaseBuckets = 8192;
+
+    // One pixel column of one lane
+    struct Column {
+        float coverage = 0.0f;  // Fraction of the column the key was held, 0 to 1
+        uint32_t presses = 0;   // Key downs starting inside the column
+    };
+
+    void build(const std::vector<KeyEvent>& events);
+    // Adds events that follow the ones already indexed, e.g. the tail of a recording
+    void append(const KeyEvent* events, size_t count);
+    void clear();
+
+    bool empty() const { return m_eventTimesUs.empty(); }
+    size_t eventCount() const { return m_eventTimesUs.size(); }
+    int64_t durationUs() const { return m_durationUs; }
+    size_t laneCount() const { return m_lanes.size(); }
+    // Key id drawn in the lane; lanes are ordered by first use
+    uint16_t laneKeyId(size_t lane) const { return m_lanes[lane].keyId; }
+
+    // Absolute time of an event, for placing the playback cursor
+    int64_t eventTimeUs(size_t eventIndex) const;
+    // First event at or after the time, or the event count past the end; O(log n)
+    size_t eventAtTime(int64_t timeUs) const;
+
+    // Fills columns [0, columnCount) covering startUs + i * usPerColumn onwards
+    void sample(size_t lane, double startUs, double usPerColumn, size_t columnCount,
+                std::vector<Column>* out) const;
+
+private:
+    struct Interval {
+        int64_t downUs;
+        int64_t upUs;
+    };
+    struct Bucket {
+        uint32_t presses = 0;
+        uint64_t heldUs = 0;
+    };
+    struct Lane {
+        uint16_t keyId = 0;
+        int64_t heldSinceUs = -1;                 // Down at the last event; drawn held to the end
+        std::vector<Interval> intervals;          // Sorted and non-overlapping
+        std::vector<std::vector<Bucket>> levels;  // levels[0] is the finest
+        size_t pyramidIntervals = 0;              // Intervals already counted in levels
+    };
+
+    static void addToBuckets(const Interval& interval, int64_t bucketUs, std::vector<Bucket>* buckets);
+    // Sums pairs of buckets into the next level up
+    static std::vector<Bucket> coarsen(const std::vector<Bucket>& finer);
+    void buildPyramid(Lane& lane) const;
+    // Grows the levels to the current duration and counts the intervals added since
+    void extendPyramid(Lane& lane) const;
+    void sampleIntervals(const Lane& lane, double startUs, double usPerColumn, size_t columnCount,
+                         std::vector<Column>* out) const;
+
+    std::vector<int64_t> m_eventTimesUs;
+    std::vector<Lane> m_lanes;
+    std::vector<int32_t> m_laneOfKey;  // Indexed by key id, -1 without a lane; sized on first use
+    int64_t m_durationUs = 0;
+    int64_t m_bucketUs = 1;  // Width of a level-0 bucket, a power of two
+};
+
+#endif // TIMELINEINDEX_H
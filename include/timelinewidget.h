@@ -0,0 +1,83 @@
+#ifndef TIMELINEWIDGET_H
+#define TIMELINEWIDGET_H
+
+#include <QString>
+#include <QWidget>
+#include <vector>
+#include "keyevent.h"
+#include "timelineindex.h"
+
+// Draws a sequence as one lane per key with a bar for every press, over a zoomable and
+// pannable time axis. Painting goes through TimelineIndex::sample(), so a repaint costs
+// the same for ten events or ten million.
+//
+// Mouse wheel zooms around the pointer, Shift+wheel or dragging pans, double-click fits
+// the whole sequence. The playback cursor follows the event the worker last sent, and
+// while it is shown a click asks for playback to continue from the clicked point.
+class TimelineWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit TimelineWidget(QWidget* parent = nullptr);
+
+    // Rebuilds the index; the view stays where it is unless it was showing everything
+    void setEvents(const std::vector<KeyEvent>& events);
+    // Folds in events that follow the ones shown, in O(count); used while recording
+    void appendEvents(const KeyEvent* events, size_t count);
+    // Takes an index built elsewhere, e.g. on the I/O thread for a loaded file
+    void setIndex(TimelineIndex index);
+    size_t eventCount() const { return m_index.eventCount(); }
+
+    // Places the cursor at an event (the playback position) and scrolls to keep it in view
+    void setPlaybackCursor(size_t eventIndex);
+    void clearPlaybackCursor();
+
+    QSize sizeHint() const override;
+
+public slots:
+    void zoomToFit();
+
+signals:
+    // A click during playback: the first event at or after the clicked time
+    void seekRequested(quint64 eventIndex);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+
+private:
+    static constexpr int kLabelWidth = 56;
+    static constexpr int kAxisHeight = 14;
+    static constexpr double kMinUsPerPixel = 1.0;
+
+    int plotWidth() const;
+    double fitUsPerPixel() const;
+    // Keeps the zoom within limits and the view over the sequence
+    void clampView();
+    void paintAxis(QPainter& painter, int plotLeft) const;
+    // Names any new lanes and refits or clamps the view after the index changed
+    void indexChanged();
+
+    TimelineIndex m_index;
+    std::vector<QString> m_laneNames;
+    std::vector<TimelineIndex::Column> m_columns;  // Reused between lanes and repaints
+
+    double m_startUs = 0.0;
+    double m_usPerPixel = 1.0;
+    bool m_fitted = true;  // Showing the whole sequence; refits as it grows
+
+    bool m_hasCursor = false;
+    int64_t m_cursorUs = 0;
+
+    bool m_dragging = false;
+    bool m_dragMoved = false;  // Past the drag distance, so the release is not a click
+    int m_dragOriginX = 0;
+    double m_dragOriginUs = 0.0;
+};
+
+#endif // TIMELINEWIDGET_H
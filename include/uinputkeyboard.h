@@ -0,0 +1,48 @@
+#ifndef UINPUTKEYBOARD_H
+#define UINPUTKEYBOARD_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <linux/input.h>
+
+// Linux injection backend: a uinput virtual keyboard.
+// One device is created per playback session and its fd is kept open for the whole
+// session, so each event costs a single write() rather than any per-event setup.
+class UinputKeyboard {
+public:
+    // Name reported by the virtual device; recorders use it to skip our own output
+    static constexpr const char* kDeviceName = "Craftium Virtual Keyboard";
+    // Time udev and the display server take to open a newly created device; anything
+    // written before then is delivered to no one
+    static constexpr std::chrono::milliseconds kSettleTime{200};
+
+    UinputKeyboard() = default;
+    ~UinputKeyboard();
+
+    UinputKeyboard(const UinputKeyboard&) = delete;
+    UinputKeyboard& operator=(const UinputKeyboard&) = delete;
+
+    // Creates the virtual device; on failure returns false and fills error if given
+    bool open(std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+
+    // Writes the key events followed by one SYN_REPORT in a single write()
+    bool send(const uint16_t* codes, const bool* down, size_t count);
+    bool send(uint16_t code, bool down) { return send(&code, &down, 1); }
+
+    // Writes ready-made EV_KEY records plus one SYN_REPORT with a single writev()
+    bool sendEvents(const input_event* events, size_t count);
+    static input_event keyEvent(uint16_t code, bool down);
+
+    // /dev/input/eventN node the kernel assigned to the virtual device, if known
+    std::string devicePath() const { return m_devicePath; }
+
+private:
+    int m_fd = -1;
+    std::string m_devicePath;
+};
+
+#endif // UINPUTKEYBOARD_H
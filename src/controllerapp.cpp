@@ -1,19 +1,21 @@
 #include "../include/controllerapp.h"
 #include "../include/playbackworker.h"
+#include "../include/sequenceioworker.h"
+#include "../include/sequencelistmodel.h"
+#include "../include/timelinewidget.h"
 #include <QApplication>
 #include <QDebug>
 #include <QThread>
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QLabel>
+#include <QListView>
+#include <QScrollBar>
 #include <QMessageBox>
 #include <QMenuBar>
 #include <QMenu>
 #include <QAction>
 #include <QFileDialog>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QFile>
 #include <QDateTime>
 #include <QFileInfo>
@@ -34,172 +36,12 @@
 #include <QScopedValueRollback>
 #include <QSignalBlocker>
 #include <QEvent>
+#include <limits>
+#include "../include/keytables.h"
+#include "../include/sequencefile.h"
 
 #ifdef _WIN32
 #include <windows.h>
-// Define the key map for Windows at file scope or within the class scope
-namespace { // Use an anonymous namespace to limit scope
-// Make the map const as it's initialized once and never modified
-const std::map<DWORD, std::string> vk_to_string_map = {
-    {VK_BACK, "Backspace"}, {VK_TAB, "Tab"}, {VK_RETURN, "Enter"},
-    {VK_SHIFT, "Shift"}, {VK_CONTROL, "Ctrl"}, {VK_MENU, "Alt"}, // VK_MENU is Alt
-    {VK_PAUSE, "Pause"}, {VK_CAPITAL, "CapsLock"},
-    {VK_ESCAPE, "Esc"}, {VK_SPACE, "Space"},
-    {VK_PRIOR, "PageUp"}, {VK_NEXT, "PageDown"}, {VK_END, "End"}, {VK_HOME, "Home"},
-    {VK_LEFT, "Left"}, {VK_UP, "Up"}, {VK_RIGHT, "Right"}, {VK_DOWN, "Down"},
-    {VK_SELECT, "Select"}, {VK_PRINT, "Print"}, {VK_EXECUTE, "Execute"},
-    {VK_SNAPSHOT, "PrintScreen"}, {VK_INSERT, "Insert"}, {VK_DELETE, "Delete"}, {VK_HELP, "Help"},
-    {VK_LWIN, "LWin"}, {VK_RWIN, "RWin"}, {VK_APPS, "Apps"},
-    {VK_SLEEP, "Sleep"},
-    {VK_NUMPAD0, "Numpad0"}, {VK_NUMPAD1, "Numpad1"}, {VK_NUMPAD2, "Numpad2"},
-    {VK_NUMPAD3, "Numpad3"}, {VK_NUMPAD4, "Numpad4"}, {VK_NUMPAD5, "Numpad5"},
-    {VK_NUMPAD6, "Numpad6"}, {VK_NUMPAD7, "Numpad7"}, {VK_NUMPAD8, "Numpad8"},
-    {VK_NUMPAD9, "Numpad9"},
-    {VK_MULTIPLY, "NumpadMultiply"}, {VK_ADD, "NumpadAdd"}, {VK_SEPARATOR, "NumpadSeparator"},
-    {VK_SUBTRACT, "NumpadSubtract"}, {VK_DECIMAL, "NumpadDecimal"}, {VK_DIVIDE, "NumpadDivide"},
-    {VK_F1, "F1"}, {VK_F2, "F2"}, {VK_F3, "F3"}, {VK_F4, "F4"}, {VK_F5, "F5"}, {VK_F6, "F6"},
-    {VK_F7, "F7"}, {VK_F8, "F8"}, {VK_F9, "F9"}, {VK_F10, "F10"}, {VK_F11, "F11"}, {VK_F12, "F12"},
-    {VK_NUMLOCK, "NumLock"}, {VK_SCROLL, "ScrollLock"},
-    {VK_LSHIFT, "LShift"}, {VK_RSHIFT, "RShift"},
-    {VK_LCONTROL, "LCtrl"}, {VK_RCONTROL, "RCtrl"},
-    {VK_LMENU, "LAlt"}, {VK_RMENU, "RAlt"},
-    // Add other keys as needed, e.g., OEM keys for punctuation
-    {VK_OEM_1, ";"}, {VK_OEM_PLUS, "="}, {VK_OEM_COMMA, ","}, {VK_OEM_MINUS, "-"},
-    {VK_OEM_PERIOD, "."}, {VK_OEM_2, "/"}, {VK_OEM_3, "`"}, {VK_OEM_4, "["},
-    {VK_OEM_5, "\\"}, {VK_OEM_6, "]"}, {VK_OEM_7, "'"}
-};
-
-// This map is modified by initialize_string_to_vk_map, so cannot be const here.
-std::map<std::string, WORD> string_to_vk_map; // Reverse map
-
-// Function to initialize the reverse map
-void initialize_string_to_vk_map() {
-    if (string_to_vk_map.empty()) {
-        for (const auto& pair : vk_to_string_map) {
-            string_to_vk_map[pair.second] = static_cast<WORD>(pair.first);
-        }
-        // Add mappings for alphanumeric keys ('A'-'Z', '0'-'9')
-        for (char c = 'A'; c <= 'Z'; ++c) {
-            string_to_vk_map[std::string(1, c)] = static_cast<WORD>(c);
-        }
-        for (char c = '0'; c <= '9'; ++c) {
-            string_to_vk_map[std::string(1, c)] = static_cast<WORD>(c);
-        }
-    }
-}
-
-} // end anonymous namespace
-
-// Windows global hook state
-// Note: These are intentionally global for single-instance application use.
-// The Windows low-level keyboard hook callback requires a C-style function pointer,
-// which necessitates global state to access the ControllerApp instance.
-// These variables are properly initialized and cleaned up in start/stopGlobalKeyListener.
-// WARNING: Do not create multiple instances of ControllerApp with recording enabled.
-HHOOK keyboardHook = NULL;
-static ControllerApp* g_appInstance = nullptr;
-
-// Windows keyboard hook callback
-LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
-    // Check if the hook is being installed - save the app instance
-    if (nCode == HC_ACTION) {
-        if (lParam && g_appInstance && g_appInstance->isRecording()) {
-            KBDLLHOOKSTRUCT* pKbStruct = (KBDLLHOOKSTRUCT*)lParam;
-            DWORD vkCode = pKbStruct->vkCode;
-            
-            bool isKeyDown = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
-            bool isKeyUp = (wParam == WM_KEYUP || wParam == WM_SYSKEYUP);
-            
-            if (isKeyDown || isKeyUp) {
-                // Call the record method from the app instance
-                g_appInstance->recordKeyEvent(vkCode, isKeyDown);
-            }
-        }
-    }
-    
-    // Always call the next hook in the chain
-    return CallNextHookEx(keyboardHook, nCode, wParam, lParam);
-}
-
-void ControllerApp::startGlobalKeyListener() {
-    if (keyboardHook) {
-        qDebug() << "Windows keyboard hook already installed.";
-        return;
-    }
-    
-    // Save the instance pointer for the hook callback
-    g_appInstance = this;
-    
-    // Install the low-level keyboard hook
-    keyboardHook = SetWindowsHookEx(
-        WH_KEYBOARD_LL,          // Low-level keyboard events
-        LowLevelKeyboardProc,    // Hook procedure
-        GetModuleHandle(NULL),   // Instance handle
-        0                        // Hook all threads
-    );
-    
-    if (!keyboardHook) {
-        DWORD error = GetLastError();
-        qCritical() << "Failed to install keyboard hook. Error code:" << error;
-        QMessageBox::critical(this, "Error", 
-                             "Failed to install keyboard hook. Error code: " + QString::number(error));
-        return;
-    }
-    
-    qDebug() << "Windows global keyboard hook installed successfully.";
-}
-
-void ControllerApp::stopGlobalKeyListener() {
-    if (keyboardHook) {
-        if (UnhookWindowsHookEx(keyboardHook)) {
-            keyboardHook = NULL;
-            g_appInstance = nullptr;
-            qDebug() << "Windows global keyboard hook removed successfully.";
-        } else {
-            DWORD error = GetLastError();
-            qWarning() << "Failed to remove keyboard hook. Error code:" << error;
-        }
-    }
-}
-
-void ControllerApp::recordKeyEvent(DWORD vkCode, bool isPress) {
-    // This method is called from the hook callback, which runs in a different thread
-    // Be careful with UI operations here
-    
-    if (!recording) return;
-    
-    auto now = std::chrono::high_resolution_clock::now();
-    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastEventTime).count();
-    lastEventTime = now;
-    
-    KeyEvent event;
-    event.delay = (delay < 0) ? 0 : delay;
-    event.state = isPress ? "down" : "up";
-    
-    // Store Windows-specific key code
-    event.winKeyCode = static_cast<WORD>(vkCode);
-    
-    // Convert to string representation
-    event.key = vkCodeToString(vkCode);
-    
-    if (event.key != "Unknown") {
-        // Add to sequence with mutex protection
-        {
-            QMutexLocker locker(&sequenceMutex);
-            sequence.push_back(event);
-        }
-        qDebug() << "Recorded (Win):" << QString::fromStdString(event.key)
-                 << QString::fromStdString(event.state) << "delay:" << event.delay;
-
-        // Update sequence text if panel is visible
-        if (sequencePanelVisible) {
-            // Use invokeMethod to safely call from another thread
-            QMetaObject::invokeMethod(this, "updateSequenceText", Qt::QueuedConnection);
-        }
-    } else {
-        qDebug() << "Ignored unknown Windows key code:" << vkCode;
-    }
-}
 #elif defined(__APPLE__)
 #include <Carbon/Carbon.h>
 #include <CoreGraphics/CoreGraphics.h>
@@ -207,7 +49,7 @@ void ControllerApp::recordKeyEvent(DWORD vkCode, bool isPress) {
 #include <CoreFoundation/CoreFoundation.h>
 #include "../include/macos_window_helper.h"  // For window level management
 
-// Define the key map for non-printable keys at file scope
+// macOS front-process helpers at file scope
 namespace { // Use anonymous namespace
 // Store the frontmost application ProcessSerialNumber before playback
 ProcessSerialNumber gLastActiveProcess = {0, 0};
@@ -232,75 +74,12 @@ bool RestoreFrontProcess(const ProcessSerialNumber* psn) {
 #pragma clang diagnostic pop
     return (err == noErr);
 }
-
-// Make the map const as it's initialized once and never modified
-const std::map<CGKeyCode, std::string> nonPrintableKeyMap = {
-    {kVK_Delete, "Backspace"}, {kVK_Tab, "Tab"}, {kVK_Return, "Enter"},
-    {kVK_Shift, "Shift"}, {kVK_Control, "Ctrl"}, {kVK_Option, "Alt"}, // Option is Alt
-    {kVK_Command, "Cmd"},
-    {kVK_RightShift, "RShift"}, {kVK_RightControl, "RCtrl"}, {kVK_RightOption, "RAlt"},
-    {kVK_RightCommand, "RCmd"},
-    {kVK_CapsLock, "CapsLock"},
-    {kVK_Escape, "Esc"}, {kVK_Space, "Space"},
-    {kVK_PageUp, "PageUp"}, {kVK_PageDown, "PageDown"}, {kVK_End, "End"}, {kVK_Home, "Home"},
-    {kVK_LeftArrow, "Left"}, {kVK_UpArrow, "Up"}, {kVK_RightArrow, "Right"}, {kVK_DownArrow, "Down"},
-    {kVK_F1, "F1"}, {kVK_F2, "F2"}, {kVK_F3, "F3"}, {kVK_F4, "F4"}, {kVK_F5, "F5"}, {kVK_F6, "F6"},
-    {kVK_F7, "F7"}, {kVK_F8, "F8"}, {kVK_F9, "F9"}, {kVK_F10, "F10"}, {kVK_F11, "F11"}, {kVK_F12, "F12"},
-    {kVK_ForwardDelete, "Delete"}, {kVK_Help, "Insert"} // Help is often Insert
-    // Add other non-printable keys as needed
-};
 } // end anonymous namespace
 
 // Forward declaration of helper for permission guidance
 static void showMacPermissionsDialog(ControllerApp* parent);
 static CGEventRef permissionTestCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void* refcon);
 
-// Define the key map at file scope - Marked as unused by linter, consider removing if truly unused.
-// Made const for good practice.
-const std::map<CGKeyCode, std::string> key_map = {
-    {kVK_Delete, "Backspace"}, {kVK_Tab, "Tab"}, {kVK_Return, "Enter"},
-    {kVK_Shift, "Shift"}, {kVK_Control, "Ctrl"}, {kVK_Option, "Alt"},
-    {kVK_CapsLock, "CapsLock"},
-    {kVK_Escape, "Esc"}, {kVK_Space, "Space"},
-    {kVK_PageUp, "PageUp"}, {kVK_PageDown, "PageDown"}, {kVK_End, "End"}, {kVK_Home, "Home"},
-    {kVK_LeftArrow, "Left"}, {kVK_UpArrow, "Up"}, {kVK_RightArrow, "Right"}, {kVK_DownArrow, "Down"}
-};
-
-// Removed static instance pointer comment
-
-// C-style callback function for the event tap
-// Mark proxy as potentially unused, make event const
-CGEventRef keyboardEventCallback([[maybe_unused]] CGEventTapProxy proxy, CGEventType type, const CGEventRef event, void *refcon) {
-    // Cast refcon back to our ControllerApp instance
-    // Use auto for type deduction
-    auto* appInstance = static_cast<ControllerApp*>(refcon);
-
-    // Debug: Log that callback was triggered
-    static int callbackCount = 0;
-    if (callbackCount < 5) { // Only log first 5 to avoid spam
-        qDebug() << "Callback triggered, count:" << ++callbackCount << "type:" << type << "isRecording:" << (appInstance ? appInstance->isRecording() : false);
-    }
-
-    if (appInstance == nullptr || !appInstance->isRecording()) { // Use a public getter for recording state
-        return event; // Pass event through if not recording or instance is null
-    }
-
-    // Check if it's a key down or key up event
-    if (type == kCGEventKeyDown || type == kCGEventKeyUp) {
-        CGKeyCode keyCode = (CGKeyCode)CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode);
-        bool isPress = (type == kCGEventKeyDown);
-
-        qDebug() << "Key event in callback - keyCode:" << keyCode << "isPress:" << isPress;
-
-        // Call the instance method via the pointer
-        appInstance->recordKeyEvent(keyCode, isPress);
-    }
-    // We don't handle kCGEventFlagsChanged here, but could if needed (e.g., for modifier keys)
-
-    // We are just observing, pass the event along
-    return event;
-}
-
 static CGEventRef permissionTestCallback([[maybe_unused]] CGEventTapProxy proxy,
                                          [[maybe_unused]] CGEventType type,
                                          CGEventRef event,
@@ -372,9 +151,18 @@ ControllerApp::ControllerApp(QWidget *parent)
     playbackThread = new QThread(this);
     playbackWorker = new PlaybackWorker();
     playbackWorker->moveToThread(playbackThread);
+    playbackWorker->setSpinThreshold(std::chrono::microseconds(
+        settings->value("spinThresholdUs",
+                        static_cast<qlonglong>(PlaybackClock::kDefaultSpinThreshold.count())).toLongLong()));
+    playbackWorker->setPreroll(std::chrono::milliseconds(
+        settings->value("playbackPrerollMs",
+                        static_cast<qlonglong>(PlaybackEngine::kDefaultPreroll.count())).toLongLong()));
+    playbackWorker->setBatchThreshold(std::chrono::microseconds(
+        settings->value("batchThresholdUs",
+                        static_cast<qlonglong>(PlaybackEngine::kDefaultBatchThreshold.count())).toLongLong()));
 
     // Register KeyEvent vector for signal/slot use
-    qRegisterMetaType<std::vector<KeyEvent>>("std::vector<KeyEvent>");
+    qRegisterMetaType<SequenceSnapshot>("SequenceSnapshot");
 
     // Connect signals/slots for thread management
     connect(playbackThread, &QThread::finished, playbackWorker, &QObject::deleteLater);
@@ -383,14 +171,82 @@ ControllerApp::ControllerApp(QWidget *parent)
     // Connect signals/slots for playback control using modern syntax
     // Using playbackWorker as context ensures lambda executes on worker thread
     connect(this, &ControllerApp::startPlaybackSignal, playbackWorker,
-            [this](const std::vector<KeyEvent>& sequence) {
-                playbackWorker->doWork(sequence, repeatCountSpinner->value());
+            [this](const SequenceSnapshot& snapshot) {
+                playbackWorker->doWork(snapshot, repeatCountSpinner->value());
             }, Qt::QueuedConnection);
     connect(this, &ControllerApp::stopPlaybackSignal, playbackWorker, &PlaybackWorker::stopWork, Qt::DirectConnection);
+    connect(playbackWorker, &PlaybackWorker::timingReport, this,
+            [this](qint64 worstLatenessUs, quint64 missedDeadlines, quint64 sendFailures) {
+        lastWorstLatenessUs = worstLatenessUs;
+        lastMissedDeadlines = missedDeadlines;
+        lastSendFailures = sendFailures;
+    });
+    connect(playbackWorker, &PlaybackWorker::passProgress, this,
+            [this](quint64 passesCompleted, double passesPerSecond) {
+                lastPassCount = passesCompleted;
+                if (playing && passesPerSecond > 0.0 && !playbackPaused) {
+                    updateStatusLabel(QString("Status: Playing, pass %1 (%2 loops/s)")
+                                          .arg(passesCompleted)
+                                          .arg(passesPerSecond, 0, 'f', 1));
+                }
+            });
     connect(playbackWorker, &PlaybackWorker::finished, this, &ControllerApp::handlePlaybackFinished);
 
     playbackThread->start();
 
+    // Sequence files are read and written on their own thread, never the GUI's
+    ioThread = new QThread(this);
+    ioWorker = new SequenceIoWorker(&sequence);
+    ioWorker->moveToThread(ioThread);
+    connect(ioThread, &QThread::finished, ioWorker, &QObject::deleteLater);
+    connect(this, &ControllerApp::loadFileSignal, ioWorker, &SequenceIoWorker::loadFile, Qt::QueuedConnection);
+    connect(this, &ControllerApp::saveFileSignal, ioWorker, &SequenceIoWorker::saveFile, Qt::QueuedConnection);
+    connect(ioWorker, &SequenceIoWorker::progress, this, [this](quint64 request, int percent) {
+        if (request == ioRequest && ioBusy) {
+            updateStatusLabel(QString("Status: %1 (%2%)").arg(ioStatus).arg(percent));
+        }
+    });
+    qRegisterMetaType<TimelineIndexPtr>("TimelineIndexPtr");
+    connect(ioWorker, &SequenceIoWorker::loadFinished, this,
+            [this](quint64 request, const QString& fileName, quint64 eventCount, const QString& error, bool cancelled,
+                   const TimelineIndexPtr& timeline) {
+        if (request != ioRequest) {
+            return;
+        }
+        endFileOperation();
+        if (cancelled) {
+            updateStatusLabel("Status: Load cancelled");
+        } else if (!error.isEmpty()) {
+            updateStatusLabel("Status: Load failed");
+            QMessageBox::warning(this, "Load Sequence", error);
+        } else {
+            qDebug() << "Loaded" << eventCount << "events from" << fileName;
+            discardJournal();
+            updateStatusLabel("Status: Sequence loaded from " + fileName);
+            // The index was built with the load; claiming the new epoch keeps the sync below from rebuilding it
+            timelineWidget->setIndex(std::move(*timeline));
+            timelineEpoch = sequence.epoch();
+            updateSequenceText();
+        }
+    });
+    connect(ioWorker, &SequenceIoWorker::saveFinished, this,
+            [this](quint64 request, const QString& fileName, const QString& error, bool cancelled) {
+        if (request != ioRequest) {
+            return;
+        }
+        endFileOperation();
+        if (cancelled) {
+            updateStatusLabel("Status: Save cancelled");
+        } else if (!error.isEmpty()) {
+            updateStatusLabel("Status: Save failed");
+            QMessageBox::warning(this, "Save Sequence", error);
+        } else {
+            discardJournal();
+            updateStatusLabel("Status: Sequence saved to " + fileName);
+        }
+    });
+    ioThread->start();
+
 #ifdef __APPLE__
     // Check Accessibility permissions at launch and show dialog if needed
     craftiumInstallFrontmostObserver();
@@ -399,6 +255,9 @@ ControllerApp::ControllerApp(QWidget *parent)
 
     // Apply Always on Top after permission prompts so dialogs stay visible
     setAlwaysOnTop(alwaysOnTop);
+
+    // Offer back a recording a crash cut short, once the window is up
+    QTimer::singleShot(0, this, &ControllerApp::recoverJournal);
 }
 
 ControllerApp::~ControllerApp() {
@@ -408,6 +267,8 @@ ControllerApp::~ControllerApp() {
     if (recording) {
         stopRecording();
     }
+    // A clean exit is a decision not to keep an unsaved recording
+    discardJournal();
 
     // Stop playback if active - call worker directly to avoid race condition
     if (playing && playbackWorker) {
@@ -421,6 +282,13 @@ ControllerApp::~ControllerApp() {
         playbackThread->wait();
     }
 
+    // Abandon any file operation; an unfinished save never replaces the old file
+    if (ioThread && ioThread->isRunning()) {
+        ioWorker->cancel(ioRequest);
+        ioThread->quit();
+        ioThread->wait();
+    }
+
 #ifdef __APPLE__
     // Clean up any active timers
     if (appSwitchCheckTimer) {
@@ -493,6 +361,8 @@ void ControllerApp::setupUI() {
     QPushButton* stopRecordButton = new QPushButton("Stop Recording", this);
     QPushButton* playExternalButton = new QPushButton("Play", this);
     QPushButton* stopPlayButton = new QPushButton("Stop", this);
+    pauseButton = new QPushButton("Pause", this);
+    pauseButton->setEnabled(false);
     QPushButton* clearButton = new QPushButton("Clear Sequence", this);
     
     // Connect buttons to slots
@@ -502,12 +372,14 @@ void ControllerApp::setupUI() {
         startPlayback(repeatCountSpinner->value(), true);
     });
     connect(stopPlayButton, &QPushButton::clicked, this, &ControllerApp::stopPlayback);
+    connect(pauseButton, &QPushButton::clicked, this, &ControllerApp::togglePausePlayback);
     connect(clearButton, &QPushButton::clicked, this, &ControllerApp::clearSequence);
 
     // Add buttons to layout
     controlsLayout->addWidget(recordButton);
     controlsLayout->addWidget(stopRecordButton);
     controlsLayout->addWidget(playExternalButton);
+    controlsLayout->addWidget(pauseButton);
     controlsLayout->addWidget(stopPlayButton);
     controlsLayout->addWidget(clearButton);
     
@@ -517,16 +389,53 @@ void ControllerApp::setupUI() {
     repeatLayout->setSpacing(5);
     QLabel* repeatLabel = new QLabel("Repeat Count:", this);
     repeatCountSpinner = new QSpinBox(this);
-    repeatCountSpinner->setMinimum(1);
-    repeatCountSpinner->setMaximum(100);
+    // The minimum doubles as "loop until stopped"
+    repeatCountSpinner->setMinimum(PlaybackEngine::kRepeatForever);
+    repeatCountSpinner->setMaximum(std::numeric_limits<int>::max());
+    repeatCountSpinner->setSpecialValueText("Forever");
     repeatCountSpinner->setValue(1);
-    repeatCountSpinner->setToolTip("Number of times to repeat the sequence");
+    repeatCountSpinner->setToolTip("Number of times to repeat the sequence (Forever loops until stopped)");
+
+    QLabel* repeatGapLabel = new QLabel("Gap:", this);
+    repeatGapSpinner = new QSpinBox(this);
+    repeatGapSpinner->setRange(0, 60000);
+    repeatGapSpinner->setSuffix(" ms");
+    repeatGapSpinner->setValue(settings->value("repeatGapMs",
+        static_cast<int>(PlaybackEngine::kDefaultRepeatGap.count())).toInt());
+    repeatGapSpinner->setToolTip("Pause between the end of one repeat and the start of the next");
+    connect(repeatGapSpinner, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        settings->setValue("repeatGapMs", value);
+    });
     
     repeatLayout->addWidget(repeatLabel);
     repeatLayout->addWidget(repeatCountSpinner);
+    repeatLayout->addWidget(repeatGapLabel);
+    repeatLayout->addWidget(repeatGapSpinner);
     repeatLayout->addStretch();
     
     controlsLayout->addLayout(repeatLayout);
+
+    // Add playback speed spinner
+    QHBoxLayout* speedLayout = new QHBoxLayout();
+    speedLayout->setContentsMargins(0, 0, 0, 5);
+    speedLayout->setSpacing(5);
+    QLabel* speedLabel = new QLabel("Speed:", this);
+    speedSpinner = new QDoubleSpinBox(this);
+    speedSpinner->setRange(0.1, 100.0);
+    speedSpinner->setDecimals(1);
+    speedSpinner->setSingleStep(0.5);
+    speedSpinner->setSuffix("x");
+    speedSpinner->setValue(settings->value("playbackSpeed", 1.0).toDouble());
+    speedSpinner->setToolTip("Playback speed multiplier (the recording is not changed)");
+    connect(speedSpinner, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [this](double value) {
+        settings->setValue("playbackSpeed", value);
+    });
+
+    speedLayout->addWidget(speedLabel);
+    speedLayout->addWidget(speedSpinner);
+    speedLayout->addStretch();
+
+    controlsLayout->addLayout(speedLayout);
     
     // Add toggle button for notes panel
     notesToggleButton = new QPushButton("▶ Notes", this);
@@ -541,17 +450,68 @@ void ControllerApp::setupUI() {
     // Add the controls widget to the main layout
     layout->addWidget(controlsWidget);
     
-    // Add sequence text edit (initially hidden)
-    sequenceTextEdit = new QTextEdit(this);
-    sequenceTextEdit->setReadOnly(true);
-    sequenceTextEdit->setVisible(false);
-    sequenceTextEdit->setMinimumHeight(0);
-    sequenceTextEdit->setMaximumHeight(0);
-    sequenceTextEdit->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
-    sequenceTextEdit->setLineWrapMode(QTextEdit::WidgetWidth); // Force text to wrap at widget width
-    sequenceTextEdit->setWordWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
-    sequenceTextEdit->setPlaceholderText("Recorded sequence will be shown here...");
-    layout->addWidget(sequenceTextEdit);
+    // Add sequence details panel (initially hidden)
+    sequencePanel = new QFrame(this);
+    sequencePanel->setVisible(false);
+    sequencePanel->setMinimumHeight(0);
+    sequencePanel->setMaximumHeight(0);
+    sequencePanel->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
+    QVBoxLayout* sequencePanelLayout = new QVBoxLayout(sequencePanel);
+    sequencePanelLayout->setContentsMargins(0, 0, 0, 0);
+    sequencePanelLayout->setSpacing(2);
+
+    // Level-of-detail timeline above the event list
+    timelineWidget = new TimelineWidget(sequencePanel);
+    timelineWidget->setFixedHeight(120);
+    sequencePanelLayout->addWidget(timelineWidget);
+    connect(timelineWidget, &TimelineWidget::seekRequested, this, [this](quint64 eventIndex) {
+        if (!playing) {
+            return;
+        }
+        // Thread-safe like pauseWork; held keys are synced to the new position. Before the
+        // run starts, this picks the event it starts from.
+        playbackWorker->seekToEvent(static_cast<size_t>(eventIndex));
+        updateStatusLabel(QString("Status: Playback moved to event %1").arg(eventIndex));
+    });
+
+    // Only visible rows are formatted and painted; uniform sizes keep layout O(1) per row
+    sequenceModel = new SequenceListModel(this);
+    sequenceView = new QListView(sequencePanel);
+    sequenceView->setModel(sequenceModel);
+    sequenceView->setUniformItemSizes(true);
+    sequenceView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    sequenceView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    sequencePanelLayout->addWidget(sequenceView);
+
+    sequenceSummaryLabel = new QLabel("No sequence recorded.", sequencePanel);
+    sequencePanelLayout->addWidget(sequenceSummaryLabel);
+    connect(sequenceModel, &SequenceListModel::totalsChanged, this, [this]() {
+        if (sequenceModel->eventCount() == 0) {
+            sequenceSummaryLabel->setText("No sequence recorded.");
+            return;
+        }
+        const long long totalTimeUs = sequenceModel->totalTimeUs();
+        sequenceSummaryLabel->setText(QString("Total events: %1 | Total time: %2ms (%3s)")
+                                          .arg(sequenceModel->eventCount())
+                                          .arg(totalTimeUs / 1000.0, 0, 'f', 3)
+                                          .arg(totalTimeUs / 1000000.0, 0, 'f', 2));
+    });
+    layout->addWidget(sequencePanel);
+
+    sequenceRefreshTimer = new QTimer(this);
+    sequenceRefreshTimer->setInterval(kRefreshIntervalMs);
+    connect(sequenceRefreshTimer, &QTimer::timeout, this, [this]() {
+        if (!sequencePanelVisible) {
+            return;
+        }
+        if (sequence.revision() != shownSequenceRevision) {
+            updateSequenceText();
+        }
+        if (playing) {
+            // The worker's position is an atomic read, safe from the GUI thread
+            timelineWidget->setPlaybackCursor(playbackWorker->position());
+        }
+    });
     
     // Status label - moved to the bottom
     statusLabel = new QLabel("Status: Ready", this);
@@ -566,14 +526,14 @@ void ControllerApp::setupUI() {
     // Record initial width so status text can be elided accordingly
 
     // Initialize animation for expanding/collapsing sequence panel
-    sequencePanelAnimation = new QPropertyAnimation(sequenceTextEdit, "maximumHeight", this);
+    sequencePanelAnimation = new QPropertyAnimation(sequencePanel, "maximumHeight", this);
     sequencePanelAnimation->setDuration(200);
     connect(sequencePanelAnimation, &QPropertyAnimation::finished, this, [this]() {
-        if (!sequencePanelVisible && sequenceTextEdit) {
-            sequenceTextEdit->setVisible(false);
-            sequenceTextEdit->setMaximumHeight(0);
-        } else if (sequencePanelVisible && sequenceTextEdit) {
-            sequenceTextEdit->setMaximumHeight(sequencePanelExpandedHeight);
+        if (!sequencePanelVisible && sequencePanel) {
+            sequencePanel->setVisible(false);
+            sequencePanel->setMaximumHeight(0);
+        } else if (sequencePanelVisible && sequencePanel) {
+            sequencePanel->setMaximumHeight(sequencePanelExpandedHeight);
         }
     });
 
@@ -694,67 +654,117 @@ bool ControllerApp::shouldRetainFocusDuringTopMode() const {
 }
 
 void ControllerApp::clearSequence() {
-    {
-        QMutexLocker locker(&sequenceMutex);
-        sequence.clear();
+    if (fileOperationBusy("Clear Sequence")) {
+        return;
     }
+    sequence.clear();
+    discardJournal();
     updateStatusLabel("Status: Sequence cleared");
     updateSequenceText();
 }
 
-void ControllerApp::saveSequence() {
-    // Make a copy of the sequence while holding the mutex
-    std::vector<KeyEvent> sequenceCopy;
-    {
-        QMutexLocker locker(&sequenceMutex);
-        if (sequence.empty()) {
-            QMessageBox::information(this, "Save Sequence", "No sequence to save.");
-            return;
-        }
-        sequenceCopy = sequence;
+bool ControllerApp::fileOperationBusy(const QString& title) {
+    if (!ioBusy) {
+        return false;
     }
+    QMessageBox::information(this, title, "Please wait for the current file operation to finish, or cancel it.");
+    return true;
+}
 
-    QString fileName = QFileDialog::getSaveFileName(this,
-        "Save Sequence", "", "JSON Files (*.json);;All Files (*)");
+void ControllerApp::beginFileOperation(const QString& verb, const QString& fileName) {
+    ioBusy = true;
+    ++ioRequest;
+    ioStatus = verb + " " + QFileInfo(fileName).fileName();
+    if (cancelIoAction) {
+        cancelIoAction->setEnabled(true);
+    }
+    updateStatusLabel("Status: " + ioStatus);
+}
 
-    if (fileName.isEmpty())
+void ControllerApp::endFileOperation() {
+    ioBusy = false;
+    if (cancelIoAction) {
+        cancelIoAction->setEnabled(false);
+    }
+}
+
+void ControllerApp::cancelFileOperation() {
+    if (ioBusy) {
+        ioWorker->cancel(ioRequest); // Direct call; the worker polls between chunks
+        updateStatusLabel("Status: Cancelling...");
+    }
+}
+
+std::filesystem::path ControllerApp::journalPath() const {
+    const QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    return QFileInfo(dir.filePath("recording.journal")).filesystemFilePath();
+}
+
+void ControllerApp::discardJournal() {
+    // The journal only matters while its recording exists nowhere else
+    if (!recording) {
+        RecordingJournal::discard(journalPath());
+    }
+}
+
+void ControllerApp::recoverJournal() {
+    RecordingJournal::Recovered recovered;
+    if (!RecordingJournal::recover(journalPath(), [this](uint16_t code) { return resolveKeyId(code); },
+                                   &recovered)) {
+        discardJournal();
         return;
+    }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        QMessageBox::warning(this, "Save Sequence",
-                            "Could not open file for writing: " + file.errorString());
+    const QString started = QDateTime::fromSecsSinceEpoch(recovered.startedAtUnix).toString("yyyy-MM-dd hh:mm");
+    qDebug() << "Recording journal from" << started << "holds" << recovered.events.size()
+             << "events, torn tail:" << recovered.tornTail;
+    const auto answer = QMessageBox::question(this, "Recover Recording",
+        QString("A recording started %1 with %2 events was not saved before Craftium closed.\n"
+                "Restore it?").arg(started).arg(recovered.events.size()));
+    if (answer != QMessageBox::Yes || recording) {
+        discardJournal();
         return;
     }
 
-    // Create JSON array to hold sequence data
-    QJsonArray sequenceArray;
+    // Kept on disk until the recovered sequence is saved or replaced
+    const size_t eventCount = recovered.events.size();
+    sequence.assign(std::move(recovered.events));
+    updateStatusLabel(QString("Status: Recovered %1 events from an unsaved recording").arg(eventCount));
+    updateSequenceText();
+}
 
-    for (const auto& event : sequenceCopy) {
-        QJsonObject eventObject;
-        eventObject["key"] = QString::fromStdString(event.key);
-        eventObject["state"] = QString::fromStdString(event.state);
-        eventObject["delay"] = static_cast<int>(event.delay);
+void ControllerApp::saveSequence() {
+    if (fileOperationBusy("Save Sequence")) {
+        return;
+    }
+    // Take a snapshot; recording may keep appending without affecting what we write
+    const SequenceSnapshot snapshot = sequence.snapshot();
+    if (snapshot->empty()) {
+        QMessageBox::information(this, "Save Sequence", "No sequence to save.");
+        return;
+    }
 
-        // Add platform-specific key codes
-#ifdef _WIN32
-        eventObject["winKeyCode"] = static_cast<int>(event.winKeyCode);
-#elif defined(__APPLE__)
-        eventObject["macKeyCode"] = static_cast<int>(event.macKeyCode);
-#endif
+    // Binary is the default; JSON stays available for interchange
+    const QString binaryFilter = "Craftium Sequences (*.crft)";
+    QString selectedFilter = binaryFilter;
+    QString fileName = QFileDialog::getSaveFileName(this,
+        "Save Sequence", "", binaryFilter + ";;JSON Files (*.json);;All Files (*)", &selectedFilter);
 
-        sequenceArray.append(eventObject);
+    if (fileName.isEmpty())
+        return;
+    if (QFileInfo(fileName).suffix().isEmpty()) {
+        fileName += selectedFilter == binaryFilter ? QString(".") + SequenceFile::kBinarySuffix : QString(".json");
     }
 
-    QJsonDocument doc(sequenceArray);
-    file.write(doc.toJson());
-    file.close();
-
-    updateStatusLabel("Status: Sequence saved to " + fileName);
-    updateSequenceText();
+    // Written on the I/O thread; saveFinished reports back
+    beginFileOperation("Saving", fileName);
+    emit saveFileSignal(ioRequest, fileName, snapshot);
 }
 
 void ControllerApp::loadSequence() {
+    if (fileOperationBusy("Load Sequence")) {
+        return;
+    }
     if (recording) {
         QMessageBox::warning(this, "Load Sequence", "Cannot load sequence while recording.");
         return;
@@ -766,59 +776,21 @@ void ControllerApp::loadSequence() {
     }
     
     QString fileName = QFileDialog::getOpenFileName(this,
-        "Load Sequence", "", "JSON Files (*.json);;All Files (*)");
+        "Load Sequence", "", "Sequence Files (*.crft *.json);;All Files (*)");
     
     if (fileName.isEmpty())
         return;
     
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) {
-        QMessageBox::warning(this, "Load Sequence",
-                            "Could not open file for reading: " + file.errorString());
-        return;
-    }
-    
-    QByteArray saveData = file.readAll();
-    QJsonDocument doc(QJsonDocument::fromJson(saveData));
-    
-    if (doc.isNull() || !doc.isArray()) {
-        QMessageBox::warning(this, "Load Sequence", "Invalid sequence file format.");
-        return;
-    }
-    
-    // Clear current sequence and load new one
-    {
-        QMutexLocker locker(&sequenceMutex);
-        sequence.clear();
-        QJsonArray sequenceArray = doc.array();
-
-        for (const QJsonValue &value : sequenceArray) {
-            if (!value.isObject())
-                continue;
-
-            QJsonObject obj = value.toObject();
-
-            KeyEvent event;
-            event.key = obj["key"].toString().toStdString();
-            event.state = obj["state"].toString().toStdString();
-            event.delay = obj["delay"].toInt();
-
-            // Load platform-specific key codes
-#ifdef _WIN32
-            event.winKeyCode = static_cast<WORD>(obj["winKeyCode"].toInt());
-#elif defined(__APPLE__)
-            event.macKeyCode = static_cast<CGKeyCode>(obj["macKeyCode"].toInt());
-#endif
-
-            sequence.push_back(event);
-        }
-    }
-
-    updateStatusLabel("Status: Sequence loaded from " + fileName);
-    updateSequenceText();
+    // Parsed on the I/O thread and swapped in whole when complete; loadFinished reports back
+    beginFileOperation("Loading", fileName);
+    emit loadFileSignal(ioRequest, fileName);
 }
 
 void ControllerApp::startRecording() {
+    if (ioBusy) {
+        updateStatusLabel("Status: Cannot record while a file operation is running");
+        return;
+    }
     if (!recording && !playing) {
         // Clear focus from any controls before starting to record
         clearFocusFromControls();
@@ -832,26 +804,42 @@ void ControllerApp::startRecording() {
 #endif
 
         recording = true;
-        {
-            QMutexLocker locker(&sequenceMutex);
-            sequence.clear();
-        }
+        sequence.clear();
         updateStatusLabel("Status: Recording started");
+
+        // Opened before the recorder starts and closed after it stops, so the drain
+        // thread never sees it change
+        if (settings->value("recordingJournal", true).toBool()) {
+            std::string journalError;
+            if (!journal.open(journalPath(), &journalError)) {
+                qWarning() << "Recording journal could not be opened:" << QString::fromStdString(journalError);
+            }
+        }
         
-        // Reset the last event time
-        lastEventTime = std::chrono::high_resolution_clock::now();
+        // Start draining before the listener so no early keystroke is missed
+        keyRecorder.start(
+            [this](uint16_t code) { return resolveKeyId(code); },
+            [this](const KeyEvent* events, size_t count) { appendRecordedEvents(events, count); });
+        sequenceRefreshTimer->start();
         
         // Start the keyboard listener
-#ifdef _WIN32
-        startGlobalKeyListener();
-#elif defined(__APPLE__)
         if (!startGlobalKeyListener()) {
             stopRecording();
+#ifdef __APPLE__
+            // Creating the event tap only fails when permissions are missing
+            updateStatusLabel("Status: Permission required to record");
+            showMacPermissionsDialog(this);
+#elif defined(__linux__)
             updateStatusLabel("Status: Failed to start recording");
-            QMessageBox::critical(this, "Recording Error", 
-                                 "Failed to start the global key listener on macOS.");
-        }
+            QMessageBox::critical(this, "Recording Error",
+                                 "Failed to open any keyboard under /dev/input.\n"
+                                 "Add your user to the 'input' group and log in again.");
+#else
+            updateStatusLabel("Status: Failed to start recording");
+            QMessageBox::critical(this, "Recording Error",
+                                 "Failed to start the global key listener.");
 #endif
+        }
     } else if (playing) {
         updateStatusLabel("Status: Cannot start recording during playback");
         QMessageBox::warning(this, "Recording Error", "Cannot start recording while playback is active.");
@@ -861,31 +849,69 @@ void ControllerApp::startRecording() {
 void ControllerApp::stopRecording() {
     if (recording) {
         recording = false;
-#ifdef __APPLE__
         stopGlobalKeyListener();
-#elif defined(_WIN32)
-        // Removed commented-out stopGlobalKeyListener call
-#endif
-        updateStatusLabel("Status: Recording stopped");
+        // Flush whatever the hook queued before the listener went quiet
+        keyRecorder.stop();
+        sequenceRefreshTimer->stop();
+        if (sequencePanelVisible) {
+            updateSequenceText(); // Show the events flushed by stop()
+        }
+        if (journal.isOpen()) {
+            journal.close(); // Commits the tail; the file stays until the sequence is saved
+            qDebug() << "Recording journal:" << journal.committedEvents() << "events in" << journal.commits() << "commits";
+            if (journal.failed()) {
+                qWarning() << "Recording journal stopped after a write error:"
+                           << QString::fromStdString(journal.errorString());
+            }
+        }
+        qDebug() << "Recorder ring high watermark:" << keyRecorder.highWatermark()
+                 << "of" << KeyRecorder::ringCapacity()
+                 << "dropped:" << keyRecorder.droppedEvents();
+
+        if (keyRecorder.droppedEvents() > 0) {
+            updateStatusLabel(QString("Status: Recording stopped (%1 events dropped)")
+                                  .arg(keyRecorder.droppedEvents()));
+        } else {
+            updateStatusLabel("Status: Recording stopped");
+        }
         // Update UI: re-enable play button, change status label?
     }
 }
 
+static QString playbackStartingStatus(int repeatCount) {
+    if (repeatCount <= PlaybackEngine::kRepeatForever) {
+        return "Status: Playback starting (looping until stopped)";
+    }
+    return QString("Status: Playback starting (%1 repeats)").arg(repeatCount);
+}
+
 void ControllerApp::startPlayback(int repeatCount, bool external) {
-    // Make a copy of the sequence while holding the mutex
-    std::vector<KeyEvent> sequenceCopy;
-    {
-        QMutexLocker locker(&sequenceMutex);
-        if (sequence.empty()) {
-            updateStatusLabel("Status: No sequence to play");
-            QMessageBox::information(this, "Playback Info", "No sequence recorded to play back.");
-            return;
-        }
-        sequenceCopy = sequence;
+    // Snapshot the sequence; the lambdas and queued signal below only share it
+    const SequenceSnapshot snapshot = sequence.snapshot();
+    if (snapshot->empty()) {
+        updateStatusLabel("Status: No sequence to play");
+        QMessageBox::information(this, "Playback Info", "No sequence recorded to play back.");
+        return;
+    }
+
+    if (ioBusy) {
+        updateStatusLabel("Status: Cannot play while a file operation is running");
+        return;
     }
 
     if (!playing && !recording) {
         playing = true;
+        playbackPaused = false;
+        const quint64 startId = ++playbackStartId;
+        // Armed now, before the focus delay and the queued start, so Stop, Pause or a timeline
+        // seek pressed before the worker picks the run up still counts
+        playbackWorker->armWork();
+        playbackWorker->setTiming(currentPlaybackTiming());
+        playbackWorker->setRealtime(currentRealtimeOptions());
+        playbackWorker->setRepeatGap(std::chrono::milliseconds(repeatGapSpinner->value()));
+        lastPassCount = 0;
+        pauseButton->setEnabled(true);
+        sequenceRefreshTimer->start(); // Also drives the timeline's playback cursor
 
         if (external) {
             updateStatusLabel(QString("Status: Click in the target application..."));
@@ -917,7 +943,7 @@ void ControllerApp::startPlayback(int repeatCount, bool external) {
                 appSwitchCheckTimer = new QTimer(this);
                 appSwitchCheckTimer->setInterval(100);  // Check every 100ms
 
-                connect(appSwitchCheckTimer, &QTimer::timeout, this, [this, repeatCount, sequenceCopy]() {
+                connect(appSwitchCheckTimer, &QTimer::timeout, this, [this, startId, repeatCount, snapshot]() {
                     if (!gWaitingForApplicationSwitch) {
                         appSwitchCheckTimer->stop();
                         return;
@@ -936,8 +962,7 @@ void ControllerApp::startPlayback(int repeatCount, bool external) {
                             gWaitingForApplicationSwitch = false;
                             appSwitchCheckTimer->stop();
 
-                            updateStatusLabel(QString("Status: Playback starting (%1 repeats)").arg(repeatCount));
-                            emit startPlaybackSignal(sequenceCopy);
+                            dispatchPlayback(startId, snapshot, repeatCount);
                         }
                     }
                 });
@@ -957,28 +982,30 @@ void ControllerApp::startPlayback(int repeatCount, bool external) {
                         }
 
                         // Cancel playback since no app switch happened
+                        emit stopPlaybackSignal();
                         playing = false;
+                        playbackPaused = false;
+                        pauseButton->setEnabled(false);
+                        pauseButton->setText("Pause");
                         updateStatusLabel("Status: Playback cancelled - no app switch detected");
                     }
                 });
             } else {
                 // Couldn't get front process, fall back to timer approach
-                QTimer::singleShot(2000, this, [this, repeatCount, sequenceCopy]() {
-                    updateStatusLabel(QString("Status: Playback starting (%1 repeats)").arg(repeatCount));
-                    emit startPlaybackSignal(sequenceCopy);
+                QTimer::singleShot(2000, this, [this, startId, repeatCount, snapshot]() {
+                    dispatchPlayback(startId, snapshot, repeatCount);
                 });
             }
 #else
-            // For non-Mac platforms, use the timer approach as before
-            QTimer::singleShot(2000, this, [this, repeatCount, sequenceCopy]() {
-                updateStatusLabel(QString("Status: Playback starting (%1 repeats)").arg(repeatCount));
-                emit startPlaybackSignal(sequenceCopy);
+            // For non-Mac platforms, use the timer approach as before; Stop during the
+            // wait leaves playing false and bumps the start id, so the timer does nothing
+            QTimer::singleShot(2000, this, [this, startId, repeatCount, snapshot]() {
+                dispatchPlayback(startId, snapshot, repeatCount);
             });
 #endif
         } else {
             // Normal playback without special focus handling
-            updateStatusLabel(QString("Status: Playback starting (%1 repeats)").arg(repeatCount));
-            emit startPlaybackSignal(sequenceCopy);
+            dispatchPlayback(startId, snapshot, repeatCount);
         }
     } else if (recording) {
         updateStatusLabel("Status: Cannot start playback during recording");
@@ -988,12 +1015,30 @@ void ControllerApp::startPlayback(int repeatCount, bool external) {
     }
 }
 
+void ControllerApp::dispatchPlayback(quint64 startId, const SequenceSnapshot& snapshot, int repeatCount) {
+    if (!playing || startId != playbackStartId) {
+        return;
+    }
+    updateStatusLabel(playbackPaused ? QString("Status: Playback paused before the first event")
+                                     : playbackStartingStatus(repeatCount));
+    emit startPlaybackSignal(snapshot);
+}
+
 void ControllerApp::stopPlayback() {
     if (playing) {
+        ++playbackStartId;  // Cancels a start still waiting out the focus delay
         emit stopPlaybackSignal();
         playing = false;
+        playbackPaused = false;
+        pauseButton->setEnabled(false);
+        pauseButton->setText("Pause");
         updateStatusLabel("Status: Playback stopped");
-        
+        // A start cancelled before dispatch never reports finished, so tidy up here too
+        if (!recording) {
+            sequenceRefreshTimer->stop();
+        }
+        timelineWidget->clearPlaybackCursor();
+
 #ifdef __APPLE__
         // Cancel app switching if we're waiting
         if (gWaitingForApplicationSwitch) {
@@ -1010,9 +1055,49 @@ void ControllerApp::stopPlayback() {
     }
 }
 
-void ControllerApp::handlePlaybackFinished() {
+void ControllerApp::togglePausePlayback() {
+    if (!playing) {
+        return;
+    }
+
+    // The worker's control calls are thread-safe, like stopWork
+    playbackPaused = !playbackPaused;
+    if (playbackPaused) {
+        playbackWorker->pauseWork();
+        pauseButton->setText("Resume");
+        updateStatusLabel(QString("Status: Playback paused at event %1").arg(playbackWorker->position()));
+    } else {
+        playbackWorker->resumeWork();
+        pauseButton->setText("Pause");
+        updateStatusLabel("Status: Playback resumed");
+    }
+}
+
+void ControllerApp::handlePlaybackFinished(const QString& error) {
     playing = false;
-    updateStatusLabel("Status: Playback completed");
+    playbackPaused = false;
+    if (!recording) {
+        sequenceRefreshTimer->stop();
+    }
+    timelineWidget->clearPlaybackCursor();
+    pauseButton->setEnabled(false);
+    pauseButton->setText("Pause");
+
+    if (!error.isEmpty()) {
+        updateStatusLabel("Status: Playback failed");
+        QMessageBox::warning(this, "Playback Error", error);
+        return;
+    }
+    if (lastSendFailures > 0) {
+        updateStatusLabel(QString("Status: Playback finished with %1 events not sent, %2 passes")
+                              .arg(lastSendFailures)
+                              .arg(lastPassCount));
+        return;
+    }
+    updateStatusLabel(QString("Status: Playback completed, %1 passes (max lateness %2ms, %3 missed deadlines)")
+                          .arg(lastPassCount)
+                          .arg(lastWorstLatenessUs / 1000.0, 0, 'f', 2)
+                          .arg(lastMissedDeadlines));
 }
 
 void ControllerApp::showAboutDialog() {
@@ -1159,14 +1244,14 @@ void ControllerApp::showHelpDialog() {
             <p>To save your recorded sequence for later use:</p>
             <ol>
                 <li>Go to "File" → "Save Recording"</li>
-                <li>Choose a location and filename (.json format)</li>
+                <li>Choose a location and filename (.crft is compact and fast to load; pick .json to share or edit the file)</li>
                 <li>Click "Save"</li>
             </ol>
             
             <p>To load a previously saved sequence:</p>
             <ol>
                 <li>Go to "File" → "Load Recording"</li>
-                <li>Browse to your saved .json file</li>
+                <li>Browse to your saved .crft or .json file</li>
                 <li>Click "Open"</li>
             </ol>
         </div>
@@ -1232,14 +1317,11 @@ void ControllerApp::showHelpDialog() {
 #ifdef _WIN32
 // Mark as const as it doesn't modify member variables
 std::string ControllerApp::vkCodeToString(DWORD vkCode) const {
-    // Handle alphanumeric keys directly
-    if ((vkCode >= 'A' && vkCode <= 'Z') || (vkCode >= '0' && vkCode <= '9')) {
-        return std::string(1, static_cast<char>(vkCode));
-    }
-
-    // Use init-statement for iterator
-    if (const auto it = vk_to_string_map.find(vkCode); it != vk_to_string_map.end()) {
-        return it->second;
+    // Compile-time table covers alphanumeric, navigation, numpad, function and OEM keys
+    if (vkCode <= UINT16_MAX) {
+        if (const auto name = KeyTables::nameForCode(static_cast<uint16_t>(vkCode)); !name.empty()) {
+            return std::string(name);
+        }
     }
 
     // Fallback for unmapped keys - get scan code and use GetKeyNameText
@@ -1268,11 +1350,8 @@ std::string ControllerApp::vkCodeToString(DWORD vkCode) const {
 
 // Mark as const as it doesn't modify member variables
 WORD ControllerApp::stringToVkCode(const std::string& keyName) const {
-    initialize_string_to_vk_map(); // Ensure map is initialized
-
-    // Use init-statement for iterator
-    if (const auto it = string_to_vk_map.find(keyName); it != string_to_vk_map.end()) {
-        return it->second;
+    if (const int code = KeyTables::codeForName(keyName); code >= 0) {
+        return static_cast<WORD>(code);
     }
 
     qDebug() << "stringToVkCode: Unmapped key name:" << QString::fromStdString(keyName);
@@ -1281,42 +1360,11 @@ WORD ControllerApp::stringToVkCode(const std::string& keyName) const {
 #elif defined(__APPLE__)
 // Mark as const as it doesn't modify member variables
 std::string ControllerApp::keyCodeToString(CGKeyCode keyCode) const {
-    // First, check our map for non-printable keys
-    // Use init-statement for iterator
-    if (const auto it = nonPrintableKeyMap.find(keyCode); it != nonPrintableKeyMap.end()) {
-        return it->second;
-    }
-
-    // Expanded map for printable keys based on US ANSI keyboard layout
-    static const std::map<CGKeyCode, std::string> printableKeyMap = {
-        {kVK_ANSI_A, "a"}, {kVK_ANSI_B, "b"}, {kVK_ANSI_C, "c"}, {kVK_ANSI_D, "d"},
-        {kVK_ANSI_E, "e"}, {kVK_ANSI_F, "f"}, {kVK_ANSI_G, "g"}, {kVK_ANSI_H, "h"},
-        {kVK_ANSI_I, "i"}, {kVK_ANSI_J, "j"}, {kVK_ANSI_K, "k"}, {kVK_ANSI_L, "l"},
-        {kVK_ANSI_M, "m"}, {kVK_ANSI_N, "n"}, {kVK_ANSI_O, "o"}, {kVK_ANSI_P, "p"},
-        {kVK_ANSI_Q, "q"}, {kVK_ANSI_R, "r"}, {kVK_ANSI_S, "s"}, {kVK_ANSI_T, "t"},
-        {kVK_ANSI_U, "u"}, {kVK_ANSI_V, "v"}, {kVK_ANSI_W, "w"}, {kVK_ANSI_X, "x"},
-        {kVK_ANSI_Y, "y"}, {kVK_ANSI_Z, "z"},
-        
-        {kVK_ANSI_0, "0"}, {kVK_ANSI_1, "1"}, {kVK_ANSI_2, "2"}, {kVK_ANSI_3, "3"},
-        {kVK_ANSI_4, "4"}, {kVK_ANSI_5, "5"}, {kVK_ANSI_6, "6"}, {kVK_ANSI_7, "7"},
-        {kVK_ANSI_8, "8"}, {kVK_ANSI_9, "9"},
-        
-        {kVK_ANSI_Equal, "="}, {kVK_ANSI_Minus, "-"}, 
-        {kVK_ANSI_LeftBracket, "["}, {kVK_ANSI_RightBracket, "]"},
-        {kVK_ANSI_Backslash, "\\"}, {kVK_ANSI_Semicolon, ";"},
-        {kVK_ANSI_Quote, "'"}, {kVK_ANSI_Comma, ","}, 
-        {kVK_ANSI_Period, "."}, {kVK_ANSI_Slash, "/"}, 
-        {kVK_ANSI_Grave, "`"},
-        
-        {kVK_Space, " "},
-        {kVK_Return, "\n"}
-    };
-    
-    // Check the printable key map
-    if (const auto it = printableKeyMap.find(keyCode); it != printableKeyMap.end()) {
-        return it->second;
+    // Non-printable names take precedence over their printable forms (Space, Enter)
+    if (const auto name = KeyTables::nameForCode(keyCode); !name.empty()) {
+        return std::string(name);
     }
-    
+
     // If we get here, it's an unknown key
     qWarning() << "keyCodeToString: Unknown key code:" << keyCode;
     return "Unknown";
@@ -1324,143 +1372,16 @@ std::string ControllerApp::keyCodeToString(CGKeyCode keyCode) const {
 
 // Mark as const as it doesn't modify member variables
 CGKeyCode ControllerApp::stringToKeyCode(const std::string& keyName) const {
-    // First check non-printable keys
-    for (const auto& [code, name] : nonPrintableKeyMap) {
-        if (name == keyName) {
-            return code;
-        }
+    // Canonical names plus aliases for uppercase letters and "\n"/"\r"
+    if (const int code = KeyTables::codeForName(keyName); code >= 0) {
+        return static_cast<CGKeyCode>(code);
     }
 
-    // Build reverse map for printable keys (on first call)
-    static std::map<std::string, CGKeyCode> reverseMap;
-    
-    if (reverseMap.empty()) {
-        // Build the reverse map from the printable key map
-        static const std::map<CGKeyCode, std::string> printableKeyMap = {
-            {kVK_ANSI_A, "a"}, {kVK_ANSI_B, "b"}, {kVK_ANSI_C, "c"}, {kVK_ANSI_D, "d"},
-            {kVK_ANSI_E, "e"}, {kVK_ANSI_F, "f"}, {kVK_ANSI_G, "g"}, {kVK_ANSI_H, "h"},
-            {kVK_ANSI_I, "i"}, {kVK_ANSI_J, "j"}, {kVK_ANSI_K, "k"}, {kVK_ANSI_L, "l"},
-            {kVK_ANSI_M, "m"}, {kVK_ANSI_N, "n"}, {kVK_ANSI_O, "o"}, {kVK_ANSI_P, "p"},
-            {kVK_ANSI_Q, "q"}, {kVK_ANSI_R, "r"}, {kVK_ANSI_S, "s"}, {kVK_ANSI_T, "t"},
-            {kVK_ANSI_U, "u"}, {kVK_ANSI_V, "v"}, {kVK_ANSI_W, "w"}, {kVK_ANSI_X, "x"},
-            {kVK_ANSI_Y, "y"}, {kVK_ANSI_Z, "z"},
-            
-            {kVK_ANSI_0, "0"}, {kVK_ANSI_1, "1"}, {kVK_ANSI_2, "2"}, {kVK_ANSI_3, "3"},
-            {kVK_ANSI_4, "4"}, {kVK_ANSI_5, "5"}, {kVK_ANSI_6, "6"}, {kVK_ANSI_7, "7"},
-            {kVK_ANSI_8, "8"}, {kVK_ANSI_9, "9"},
-            
-            {kVK_ANSI_Equal, "="}, {kVK_ANSI_Minus, "-"}, 
-            {kVK_ANSI_LeftBracket, "["}, {kVK_ANSI_RightBracket, "]"},
-            {kVK_ANSI_Backslash, "\\"}, {kVK_ANSI_Semicolon, ";"},
-            {kVK_ANSI_Quote, "'"}, {kVK_ANSI_Comma, ","}, 
-            {kVK_ANSI_Period, "."}, {kVK_ANSI_Slash, "/"}, 
-            {kVK_ANSI_Grave, "`"},
-            
-            {kVK_Space, " "},
-            {kVK_Return, "\n"}
-        };
-        
-        // Create reverse mapping
-        for (const auto& [code, name] : printableKeyMap) {
-            reverseMap[name] = code;
-        }
-        
-        // Add special cases for uppercase/lowercase
-        for (char c = 'A'; c <= 'Z'; c++) {
-            // Map uppercase to same key as lowercase
-            std::string upper(1, c);
-            std::string lower(1, c + 32); // Convert to lowercase
-            
-            // Use the appropriate ANSI key code
-            CGKeyCode keyCode = kVK_ANSI_A + (c - 'A');
-            reverseMap[upper] = keyCode;
-            
-            // Only add lowercase if it doesn't exist yet
-            if (reverseMap.find(lower) == reverseMap.end()) {
-                reverseMap[lower] = keyCode;
-            }
-        }
-        
-        // Add aliases for Enter/Return
-        reverseMap["Enter"] = kVK_Return;
-        reverseMap["\r"] = kVK_Return;
-    }
-    
-    // Check if the key is in our reverse map
-    if (const auto it = reverseMap.find(keyName); it != reverseMap.end()) {
-        return it->second;
-    }
-    
     // If we get here, it's an unknown key
     qWarning() << "stringToKeyCode: Could not find key code for:" << QString::fromStdString(keyName);
     return UINT16_MAX; // Indicate failure
 }
 
-bool ControllerApp::startGlobalKeyListener() {
-    if (eventTap) {
-        qDebug() << "Event tap already running.";
-        return true; // Already started
-    }
-
-    qDebug() << "Attempting to start global key listener...";
-
-    // Try to create an event tap first - this is the real test of permissions
-    // NOTE: For unsigned apps, AXIsProcessTrusted() can return false even when
-    // permissions work, so we test by actually creating the tap
-    CGEventMask eventMask = (1 << kCGEventKeyDown) | (1 << kCGEventKeyUp) | (1 << kCGEventFlagsChanged);
-
-    eventTap = CGEventTapCreate(kCGHIDEventTap, // Tap HID events
-                              kCGHeadInsertEventTap, // Insert before existing taps
-                              kCGEventTapOptionListenOnly, // Just listen, don't modify
-                              eventMask, // Mask for keydown/up/flags
-                              keyboardEventCallback, // The C callback function
-                              this); // Pass 'this' as user data (refcon)
-
-    if (!eventTap) {
-        // Event tap creation failed - this means we definitely don't have permissions
-        qCritical() << "Failed to create event tap - permissions likely not granted";
-        updateStatusLabel("Status: Permission required to record");
-        showMacPermissionsDialog(this);
-
-        return false;
-    }
-
-    // Event tap created successfully!
-    qDebug() << "Event tap created successfully";
-
-    // Create a run loop source
-    runLoopSource = CFMachPortCreateRunLoopSource(kCFAllocatorDefault, eventTap, 0);
-    if (!runLoopSource) {
-         qCritical() << "Failed to create run loop source";
-         CFRelease(eventTap);
-         eventTap = nullptr;
-         QMessageBox::critical(this, "Error",
-                               "Failed to create run loop source for keyboard listener. Please try restarting the application.");
-         return false;
-    }
-
-    // Add the source to the current run loop
-    CFRunLoopAddSource(CFRunLoopGetCurrent(), runLoopSource, kCFRunLoopCommonModes);
-
-    // Enable the event tap
-    CGEventTapEnable(eventTap, true);
-
-    qDebug() << "Global key listener started successfully (macOS Event Tap)";
-    return true;
-}
-
-void ControllerApp::stopGlobalKeyListener() {
-    if (eventTap) {
-        CGEventTapEnable(eventTap, false);
-        CFRunLoopRemoveSource(CFRunLoopGetCurrent(), runLoopSource, kCFRunLoopCommonModes);
-        CFRelease(runLoopSource);
-        runLoopSource = nullptr;
-        CFRelease(eventTap);
-        eventTap = nullptr;
-        qDebug() << "Global key listener stopped (macOS Event Tap)";
-    }
-}
-
 bool ControllerApp::hasInputMonitoringPermission() const {
     CGEventMask eventMask = (1 << kCGEventKeyDown) | (1 << kCGEventKeyUp);
     CFMachPortRef tempTap = CGEventTapCreate(kCGHIDEventTap,
@@ -1560,60 +1481,100 @@ bool ControllerApp::isRecording() const {
     return recording;
 }
 
-// Existing recordKeyEvent implementation remains (now public)
-// Removed comment about guarding with #ifdef
-#ifdef __APPLE__
-void ControllerApp::recordKeyEvent(CGKeyCode keyCode, bool isPress) {
-    // This method might be called from a non-GUI thread (event tap callback)
-    // Avoid complex UI updates here. If needed, use signals or invokeMethod.
-
-    // We check recording status in the callback now, but an extra check here is harmless
-    if (!recording) return;
-
-    auto now = std::chrono::high_resolution_clock::now();
-    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastEventTime).count();
-    lastEventTime = now;
-
-    KeyEvent event;
-    event.delay = (delay < 0) ? 0 : delay;
-    event.state = isPress ? "down" : "up";
-
-    event.macKeyCode = keyCode; // Use the passed keycode directly
-    // Call the const version of keyCodeToString
-    event.key = this->keyCodeToString(event.macKeyCode);
-
-    if (event.key != "Unknown") {
-        // Add to sequence with mutex protection
-        {
-            QMutexLocker locker(&sequenceMutex);
-            sequence.push_back(event);
-        }
-        qDebug() << "Recorded:" << QString::fromStdString(event.key) << QString::fromStdString(event.state) << "delay:" << event.delay;
+bool ControllerApp::startGlobalKeyListener() {
+    if (!inputSource) {
+        inputSource = createPlatformSource();
+    }
+    if (!inputSource) {
+        qWarning() << "No keyboard capture backend on this platform";
+        return false;
+    }
+    if (inputSource->isRunning()) {
+        return true;
+    }
 
-        // Update sequence text if panel is visible
-        if (sequencePanelVisible) {
-            updateSequenceText();
-        }
-    } else {
-        qDebug() << "Ignored unknown key code:" << keyCode;
+    // The source only hands raw events to the recorder's ring; name lookup and
+    // sequence storage happen on the recorder's drain thread
+    std::string error;
+    const bool started = inputSource->start(
+        [this](uint16_t code, bool isPress, int64_t timestampNs) {
+            keyRecorder.pushAt(code, isPress, timestampNs);
+        },
+        &error);
+
+    if (!started) {
+        qCritical() << "Failed to start global key listener:" << QString::fromStdString(error);
+        return false;
+    }
+    qDebug() << "Global key listener started";
+    return true;
+}
+
+void ControllerApp::stopGlobalKeyListener() {
+    if (inputSource && inputSource->isRunning()) {
+        inputSource->stop();
+        qDebug() << "Global key listener stopped";
     }
 }
-#endif 
+
+uint16_t ControllerApp::resolveKeyId(uint16_t code) const {
+#ifdef _WIN32
+    return KeyNames::intern(vkCodeToString(code));
+#elif defined(__APPLE__)
+    return KeyNames::intern(keyCodeToString(code));
+#elif defined(__linux__)
+    const std::string_view name = KeyTables::nameForCode(code);
+    return name.empty() ? KeyNames::kUnknown : KeyNames::intern(std::string(name));
+#else
+    Q_UNUSED(code);
+    return KeyNames::kUnknown;
+#endif
+}
+
+RealtimeOptions ControllerApp::currentRealtimeOptions() const {
+    // The toggle lives in the Playback menu; CPU and priority are settings-only
+    RealtimeOptions options;
+    options.enabled = settings->value("realtimePlayback", false).toBool();
+    options.cpu = settings->value("realtimeCpu", -1).toInt();
+    options.priority = settings->value("realtimePriority", 0).toInt();
+    options.lockMemory = settings->value("realtimeLockMemory", true).toBool();
+    return options;
+}
+
+PlaybackTiming ControllerApp::currentPlaybackTiming() const {
+    // Compression rules have no UI yet; they are read from settings in milliseconds
+    PlaybackTiming timing;
+    timing.speed = speedSpinner ? speedSpinner->value() : 1.0;
+    timing.maxGapUs = settings->value("playbackMaxGapMs", 0).toLongLong() * 1000;
+    timing.idleThresholdUs = settings->value("playbackIdleThresholdMs", 0).toLongLong() * 1000;
+    timing.idleGapUs = settings->value("playbackIdleGapMs", 0).toLongLong() * 1000;
+    timing.minHoldUs = settings->value("playbackMinHoldMs", 0).toLongLong() * 1000;
+    return timing;
+}
+
+void ControllerApp::appendRecordedEvents(const KeyEvent* events, size_t count) {
+    // Runs on the recorder's drain thread
+    sequence.append(events, count);
+    if (journal.isOpen()) {
+        journal.append(events, count); // Copies into the pending block; the disk is the journal thread's job
+    }
+    // Nothing else here: the GUI picks the change up from sequence.revision() on its next frame
+}
 
 // Add toggleSequencePanel method to show/hide sequence details
 void ControllerApp::toggleSequencePanel() {
-    if (!sequenceTextEdit || !sequencePanelAnimation) {
+    if (!sequencePanel || !sequencePanelAnimation) {
         return;
     }
 
     sequencePanelVisible = !sequencePanelVisible;
 
     sequencePanelAnimation->stop();
-    sequencePanelAnimation->setStartValue(sequenceTextEdit->maximumHeight());
+    sequencePanelAnimation->setStartValue(sequencePanel->maximumHeight());
 
     if (sequencePanelVisible) {
         updateSequenceText();
-        sequenceTextEdit->setVisible(true);
+        sequencePanel->setVisible(true);
         expandButton->setText("▲ Hide Sequence Details");
         sequencePanelAnimation->setEndValue(sequencePanelExpandedHeight);
     } else {
@@ -1651,49 +1612,32 @@ void ControllerApp::toggleNotesPanel() {
 
 // Add updateSequenceText method to display sequence details
 void ControllerApp::updateSequenceText() {
-    if (!sequenceTextEdit) return;
-
-    // Make a copy of the sequence while holding the mutex
-    std::vector<KeyEvent> sequenceCopy;
-    {
-        QMutexLocker locker(&sequenceMutex);
-        if (sequence.empty()) {
-            sequenceTextEdit->setText("No sequence recorded.");
-            return;
-        }
-        sequenceCopy = sequence;
-    }
-
-    QString text;
-    long long totalTime = 0;
-
-    for (size_t i = 0; i < sequenceCopy.size(); ++i) {
-        const KeyEvent& event = sequenceCopy[i];
-        totalTime += event.delay;
+    if (!sequenceModel) return;
+    // Read before syncing; a change that lands mid-sync just triggers one more refresh
+    shownSequenceRevision = sequence.revision();
 
-        QString line;
-
-        if (i == 0) {
-            // First event
-            line = QString("Wait %1ms\n").arg(event.delay);
-        } else {
-            line = QString("Key %1 %2 (wait %3ms)\n")
-                      .arg(QString::fromStdString(event.key))
-                      .arg(QString::fromStdString(event.state))
-                      .arg(event.delay);
-        }
-
-        text.append(line);
+    // Follow new events only while the user has not scrolled up to look at older ones
+    const QScrollBar* scrollBar = sequenceView->verticalScrollBar();
+    const bool atEnd = scrollBar->value() == scrollBar->maximum();
+    sequenceModel->sync(sequence);
+    if (atEnd) {
+        sequenceView->scrollToBottom();
     }
 
-    // Add summary information
-    text.append(QString("\n--- Summary ---\n"));
-    text.append(QString("Total events: %1\n").arg(sequenceCopy.size()));
-    text.append(QString("Total time: %1ms (%2s)\n")
-                   .arg(totalTime)
-                   .arg(totalTime / 1000.0, 0, 'f', 2));
+    syncTimeline();
+}
 
-    sequenceTextEdit->setText(text);
+void ControllerApp::syncTimeline() {
+    const std::vector<KeyEvent>& events = sequenceModel->events();
+    const size_t shown = timelineWidget->eventCount();
+    if (sequenceModel->epoch() != timelineEpoch || events.size() < shown) {
+        // Cleared or replaced: start over, which is cheap for anything but a load
+        timelineWidget->setEvents(events);
+        timelineEpoch = sequenceModel->epoch();
+    } else if (events.size() > shown) {
+        // Recording only ever adds to the end, so each refresh folds in just the new tail
+        timelineWidget->appendEvents(events.data() + shown, events.size() - shown);
+    }
 }
 
 void ControllerApp::clearFocusFromControls() {
@@ -1889,7 +1833,7 @@ void ControllerApp::applyTheme(bool darkMode) {
             QPushButton:pressed {
                 background-color: #5d5d5d;
             }
-            QTextEdit {
+            QTextEdit, QListView {
                 background-color: #363636;
                 border: 1px solid #5d5d5d;
                 color: #e0e0e0;
@@ -1957,6 +1901,20 @@ void ControllerApp::setupMenuBar() {
     
     QAction* clearAction = fileMenu->addAction("&Clear Recording");
     connect(clearAction, &QAction::triggered, this, &ControllerApp::clearSequence);
+
+    QAction* journalAction = fileMenu->addAction("Crash-Safe Recording &Journal");
+    journalAction->setCheckable(true);
+    journalAction->setChecked(settings->value("recordingJournal", true).toBool());
+    journalAction->setToolTip("Stream recordings to disk as they are captured so a crash cannot lose them");
+    connect(journalAction, &QAction::toggled, this, [this](bool enabled) {
+        settings->setValue("recordingJournal", enabled);
+        updateStatusLabel(enabled ? "Status: Recording journal enabled for the next recording"
+                                  : "Status: Recording journal disabled");
+    });
+
+    cancelIoAction = fileMenu->addAction("Cancel &File Operation");
+    cancelIoAction->setEnabled(false);
+    connect(cancelIoAction, &QAction::triggered, this, &ControllerApp::cancelFileOperation);
     
     fileMenu->addSeparator();
     
@@ -1979,6 +1937,19 @@ void ControllerApp::setupMenuBar() {
     QAction* showSequenceAction = viewMenu->addAction("&Show Sequence Panel");
     connect(showSequenceAction, &QAction::triggered, this, &ControllerApp::toggleSequencePanel);
     
+    // Playback menu
+    QMenu* playbackMenu = menuBar->addMenu("&Playback");
+
+    QAction* realtimeAction = playbackMenu->addAction("&Low-Latency Mode");
+    realtimeAction->setCheckable(true);
+    realtimeAction->setChecked(settings->value("realtimePlayback", false).toBool());
+    realtimeAction->setToolTip("Run playback with real-time scheduling and locked memory where permitted");
+    connect(realtimeAction, &QAction::toggled, this, [this](bool enabled) {
+        settings->setValue("realtimePlayback", enabled);
+        updateStatusLabel(enabled ? "Status: Low-latency playback enabled for the next run"
+                                  : "Status: Low-latency playback disabled");
+    });
+
     // Help menu
     QMenu* helpMenu = menuBar->addMenu("&Help");
     
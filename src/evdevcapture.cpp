@@ -0,0 +1,304 @@
+#include "../include/evdevcapture.h"
+#include "../include/uinputkeyboard.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+
+namespace { // Use an anonymous namespace to limit scope
+constexpr const char* kInputDir = "/dev/input";
+constexpr int kMaxEpollEvents = 16;
+constexpr size_t kReadBatch = 64;
+
+bool testBit(const unsigned long* bits, int bit) {
+    constexpr int kBitsPerLong = sizeof(unsigned long) * CHAR_BIT;
+    return (bits[bit / kBitsPerLong] >> (bit % kBitsPerLong)) & 1UL;
+}
+
+// Treat a device as a keyboard if it reports letter and space keys
+bool isKeyboard(int fd) {
+    unsigned long keyBits[(KEY_MAX + 1) / (sizeof(unsigned long) * CHAR_BIT) + 1] = {0};
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) < 0) {
+        return false;
+    }
+    return testBit(keyBits, KEY_A) && testBit(keyBits, KEY_Z) && testBit(keyBits, KEY_SPACE);
+}
+
+bool isEventNode(const char* name) {
+    return std::strncmp(name, "event", 5) == 0;
+}
+
+int64_t timestampOf(const input_event& ev) {
+    return static_cast<int64_t>(ev.input_event_sec) * 1000000000LL
+         + static_cast<int64_t>(ev.input_event_usec) * 1000LL;
+}
+
+// Current state of every key on the device; false if the kernel would not say
+template <size_t N>
+bool readKeyState(int fd, std::bitset<N>* keys) {
+    unsigned long keyBits[(KEY_MAX + 1) / (sizeof(unsigned long) * CHAR_BIT) + 1] = {0};
+    if (ioctl(fd, EVIOCGKEY(sizeof(keyBits)), keyBits) < 0) {
+        return false;
+    }
+    keys->reset();
+    for (size_t code = 0; code < N && code <= KEY_MAX; ++code) {
+        keys->set(code, testBit(keyBits, static_cast<int>(code)));
+    }
+    return true;
+}
+} // end anonymous namespace
+
+EvdevCapture::~EvdevCapture() {
+    stop();
+}
+
+bool EvdevCapture::start(KeyCallback callback, std::string* error) {
+    stop();
+    m_callback = std::move(callback);
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeFd < 0 || m_inotifyFd < 0) {
+        if (error) *error = std::string("epoll/eventfd/inotify setup failed: ") + std::strerror(errno);
+        stop();
+        return false;
+    }
+
+    epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+
+    // IN_ATTRIB catches udev fixing up permissions after a hot-plugged node appears
+    if (inotify_add_watch(m_inotifyFd, kInputDir, IN_CREATE | IN_ATTRIB) >= 0) {
+        ev.data.fd = m_inotifyFd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_inotifyFd, &ev);
+    }
+
+    scanDevices();
+    if (m_devices.empty()) {
+        if (error) {
+            *error = "No readable keyboard found under /dev/input "
+                     "(the user usually needs to be in the 'input' group)";
+        }
+        stop();
+        return false;
+    }
+
+    m_thread = std::thread(&EvdevCapture::captureLoop, this);
+    return true;
+}
+
+void EvdevCapture::stop() {
+    if (m_thread.joinable()) {
+        const uint64_t one = 1;
+        ssize_t ignored = write(m_wakeFd, &one, sizeof(one));
+        (void)ignored;
+        m_thread.join();
+    }
+
+    for (const auto& [fd, device] : m_devices) {
+        close(fd);
+    }
+    m_devices.clear();
+    m_deviceCount = 0;
+
+    for (int* fd : {&m_epollFd, &m_inotifyFd, &m_wakeFd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void EvdevCapture::captureLoop() {
+    // Best effort: a real-time priority keeps capture timing clear of desktop load.
+    // Without CAP_SYS_NICE this fails and we stay at normal priority.
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+    epoll_event events[kMaxEpollEvents];
+    for (;;) {
+        const int count = epoll_wait(m_epollFd, events, kMaxEpollEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == m_wakeFd) {
+                return;
+            }
+            if (fd == m_inotifyFd) {
+                handleInotify();
+            } else if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                removeDevice(fd);
+            } else {
+                readDevice(fd);
+            }
+        }
+    }
+}
+
+void EvdevCapture::scanDevices() {
+    DIR* dir = opendir(kInputDir);
+    if (!dir) {
+        return;
+    }
+    while (dirent* entry = readdir(dir)) {
+        if (isEventNode(entry->d_name)) {
+            addDevice(std::string(kInputDir) + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+}
+
+bool EvdevCapture::addDevice(const std::string& path) {
+    for (const auto& [fd, existing] : m_devices) {
+        if (existing.path == path) {
+            return true;
+        }
+    }
+
+    const int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    char name[256] = {0};
+    ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name);
+    // Never record our own playback device
+    if (!isKeyboard(fd) || std::strcmp(name, UinputKeyboard::kDeviceName) == 0) {
+        close(fd);
+        return false;
+    }
+
+    // Kernel timestamps on the same clock as std::chrono::steady_clock
+    int clockId = CLOCK_MONOTONIC;
+    ioctl(fd, EVIOCSCLOCKID, &clockId);
+
+    epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        close(fd);
+        return false;
+    }
+
+    // Keys already down count as reported, so a resync only reports real changes
+    Device device;
+    device.path = path;
+    readKeyState(fd, &device.keysDown);
+    m_devices.emplace(fd, std::move(device));
+    m_deviceCount = m_devices.size();
+    return true;
+}
+
+void EvdevCapture::removeDevice(int fd) {
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    m_devices.erase(fd);
+    m_deviceCount = m_devices.size();
+}
+
+void EvdevCapture::readDevice(int fd) {
+    input_event buffer[kReadBatch];
+    for (;;) {
+        const ssize_t bytes = read(fd, buffer, sizeof(buffer));
+        if (bytes < 0) {
+            if (errno == ENODEV) {
+                removeDevice(fd); // Unplugged
+            }
+            return; // EAGAIN: drained
+        }
+        if (bytes == 0) {
+            return;
+        }
+
+        const auto found = m_devices.find(fd);
+        if (found == m_devices.end()) {
+            return;
+        }
+        Device& device = found->second;
+
+        const size_t count = static_cast<size_t>(bytes) / sizeof(input_event);
+        for (size_t i = 0; i < count; ++i) {
+            const input_event& ev = buffer[i];
+            if (ev.type == EV_SYN && ev.code == SYN_DROPPED) {
+                // The kernel's buffer overran: everything up to the next report is incomplete
+                device.dropping = true;
+                continue;
+            }
+            if (device.dropping) {
+                if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+                    device.dropping = false;
+                    resyncDevice(fd, device, timestampOf(ev));
+                }
+                continue;
+            }
+            // value 2 is autorepeat, which the display server regenerates for held keys
+            if (ev.type != EV_KEY || ev.value > 1) {
+                continue;
+            }
+            if (ev.code < kKeyCount) {
+                device.keysDown.set(ev.code, ev.value == 1);
+            }
+            m_callback(ev.code, ev.value == 1, timestampOf(ev));
+        }
+    }
+}
+
+void EvdevCapture::resyncDevice(int fd, Device& device, int64_t timestampNs) {
+    std::bitset<kKeyCount> keysDown;
+    if (!readKeyState(fd, &keysDown)) {
+        return;
+    }
+    // Releases first, so a key swapped for another mid-drop never looks like a chord
+    const std::bitset<kKeyCount> released = device.keysDown & ~keysDown;
+    const std::bitset<kKeyCount> pressed = keysDown & ~device.keysDown;
+    for (size_t code = 0; code < kKeyCount; ++code) {
+        if (released.test(code)) {
+            m_callback(static_cast<uint16_t>(code), false, timestampNs);
+        }
+    }
+    for (size_t code = 0; code < kKeyCount; ++code) {
+        if (pressed.test(code)) {
+            m_callback(static_cast<uint16_t>(code), true, timestampNs);
+        }
+    }
+    device.keysDown = keysDown;
+}
+
+void EvdevCapture::handleInotify() {
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t bytes = read(m_inotifyFd, buffer, sizeof(buffer));
+        if (bytes <= 0) {
+            return;
+        }
+        for (ssize_t offset = 0; offset < bytes;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len > 0 && isEventNode(event->name)) {
+                addDevice(std::string(kInputDir) + "/" + event->name);
+            }
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+}
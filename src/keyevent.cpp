@@ -0,0 +1,65 @@
+#include "../include/keyevent.h"
+#include "../include/keytables.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Id layout: 0 is "Unknown", 1..KeyTables::size() are the platform key table entries
+// (resolved without locking), and names outside the table are assigned after that.
+
+namespace { // Use an anonymous namespace to limit scope
+struct KeyNameTable {
+    std::mutex mutex;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint16_t> ids;
+};
+
+KeyNameTable& keyNameTable() {
+    static KeyNameTable table;
+    return table;
+}
+
+size_t firstDynamicId() {
+    return KeyTables::size() + 1;
+}
+} // end anonymous namespace
+
+uint16_t KeyNames::intern(const std::string& name) {
+    if (const int index = KeyTables::indexForName(name); index >= 0) {
+        return static_cast<uint16_t>(index + 1);
+    }
+    if (name == "Unknown") {
+        return kUnknown;
+    }
+
+    KeyNameTable& table = keyNameTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    if (const auto it = table.ids.find(name); it != table.ids.end()) {
+        return it->second;
+    }
+
+    // Id space is 16 bits; anything past that is reported as unknown
+    const size_t id = firstDynamicId() + table.names.size();
+    if (id > UINT16_MAX) {
+        return kUnknown;
+    }
+
+    table.names.push_back(name);
+    table.ids.emplace(name, static_cast<uint16_t>(id));
+    return static_cast<uint16_t>(id);
+}
+
+std::string KeyNames::name(uint16_t id) {
+    if (id == kUnknown) {
+        return "Unknown";
+    }
+    if (id < firstDynamicId()) {
+        return std::string(KeyTables::entry(id - 1).name);
+    }
+
+    KeyNameTable& table = keyNameTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    const size_t index = id - firstDynamicId();
+    return (index < table.names.size()) ? table.names[index] : std::string("Unknown");
+}
@@ -0,0 +1,86 @@
+#include "../include/keyrecorder.h"
+#include <vector>
+
+namespace { // Use an anonymous namespace to limit scope
+constexpr size_t kDrainBatchSize = 256;
+constexpr std::chrono::milliseconds kDrainInterval{2};
+} // end anonymous namespace
+
+KeyRecorder::~KeyRecorder() {
+    stop();
+}
+
+void KeyRecorder::start(KeyResolver resolver, EventSink sink) {
+    stop();
+
+    m_resolver = std::move(resolver);
+    m_sink = std::move(sink);
+    m_keyIdCache.clear();
+    m_ring.resetStats();
+
+    // The first event's delay is measured from the moment recording starts
+    m_lastTimestampNs = nowNs();
+
+    m_running.store(true, std::memory_order_release);
+    m_drainThread = std::thread(&KeyRecorder::drainLoop, this);
+}
+
+void KeyRecorder::stop() {
+    if (!m_drainThread.joinable()) {
+        return;
+    }
+
+    m_running.store(false, std::memory_order_release);
+    m_drainThread.join();
+
+    // Pick up anything the hook pushed after the thread's last pass
+    while (drainOnce() > 0) {
+    }
+}
+
+void KeyRecorder::drainLoop() {
+    while (m_running.load(std::memory_order_acquire)) {
+        if (drainOnce() == 0) {
+            std::this_thread::sleep_for(kDrainInterval);
+        }
+    }
+}
+
+size_t KeyRecorder::drainOnce() {
+    RawKeyEvent raw[kDrainBatchSize];
+    const size_t count = m_ring.popBatch(raw, kDrainBatchSize);
+    if (count == 0) {
+        return 0;
+    }
+
+    std::vector<KeyEvent> events;
+    events.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t keyId;
+        if (const auto it = m_keyIdCache.find(raw[i].code); it != m_keyIdCache.end()) {
+            keyId = it->second;
+        } else {
+            keyId = m_resolver ? m_resolver(raw[i].code) : KeyNames::kUnknown;
+            m_keyIdCache.emplace(raw[i].code, keyId);
+        }
+
+        // Unknown keys are skipped; their gap folds into the next recorded event
+        if (keyId == KeyNames::kUnknown) {
+            continue;
+        }
+
+        // Advance the reference by exactly the delay we stored, so the sub-microsecond
+        // remainder carries into the next gap instead of being lost every event.
+        // Out-of-order OS timestamps clamp to a zero delay.
+        const int64_t delayNs = raw[i].timestampNs - m_lastTimestampNs;
+        const uint32_t delayUs = KeyEvent::clampDelayUs(delayNs / 1000);
+        m_lastTimestampNs += static_cast<int64_t>(delayUs) * 1000;
+        events.emplace_back(keyId, raw[i].code, raw[i].down, delayUs);
+    }
+
+    if (!events.empty() && m_sink) {
+        m_sink(events.data(), events.size());
+    }
+    return count;
+}
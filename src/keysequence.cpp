@@ -0,0 +1,67 @@
+#include "../include/keysequence.h"
+
+KeySequence::KeySequence()
+    : m_events(std::make_shared<std::vector<KeyEvent>>()) {}
+
+SequenceSnapshot KeySequence::snapshot() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events;
+}
+
+void KeySequence::append(const KeyEvent* events, size_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<KeyEvent>& target = detach();
+    target.insert(target.end(), events, events + count);
+    m_revision.fetch_add(1, std::memory_order_release);
+}
+
+void KeySequence::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Outstanding snapshots keep the old buffer alive; we simply stop referring to it
+    m_events = std::make_shared<std::vector<KeyEvent>>();
+    ++m_epoch;
+    m_revision.fetch_add(1, std::memory_order_release);
+}
+
+void KeySequence::assign(std::vector<KeyEvent>&& events) {
+    auto replacement = std::make_shared<std::vector<KeyEvent>>(std::move(events));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events = std::move(replacement);
+    ++m_epoch;
+    m_revision.fetch_add(1, std::memory_order_release);
+}
+
+bool KeySequence::empty() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events->empty();
+}
+
+size_t KeySequence::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events->size();
+}
+
+uint64_t KeySequence::epoch() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_epoch;
+}
+
+uint64_t KeySequence::copyTail(size_t first, std::vector<KeyEvent>* out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (first < m_events->size()) {
+        out->insert(out->end(), m_events->begin() + static_cast<std::ptrdiff_t>(first), m_events->end());
+    }
+    return m_epoch;
+}
+
+std::vector<KeyEvent>& KeySequence::detach() {
+    // Snapshots are only handed out under m_mutex, so a use count of one here
+    // means no other thread can start sharing this buffer while we write to it
+    if (m_events.use_count() > 1) {
+        auto copy = std::make_shared<std::vector<KeyEvent>>();
+        copy->reserve(m_events->capacity() > 0 ? m_events->capacity() : 1024);
+        copy->assign(m_events->begin(), m_events->end());
+        m_events = std::move(copy);
+    }
+    return *m_events;
+}
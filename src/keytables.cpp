@@ -0,0 +1,191 @@
+#include "../include/keytables.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <Carbon/Carbon.h>
+#elif defined(__linux__)
+#include <linux/input-event-codes.h>
+#endif
+
+namespace { // Use an anonymous namespace to limit scope
+
+#ifdef _WIN32
+constexpr KeyTableEntry kPlatformKeyEntries[] = {
+    {VK_BACK, "Backspace"}, {VK_TAB, "Tab"}, {VK_RETURN, "Enter"},
+    {VK_SHIFT, "Shift"}, {VK_CONTROL, "Ctrl"}, {VK_MENU, "Alt"}, // VK_MENU is Alt
+    {VK_PAUSE, "Pause"}, {VK_CAPITAL, "CapsLock"},
+    {VK_ESCAPE, "Esc"}, {VK_SPACE, "Space"},
+    {VK_PRIOR, "PageUp"}, {VK_NEXT, "PageDown"}, {VK_END, "End"}, {VK_HOME, "Home"},
+    {VK_LEFT, "Left"}, {VK_UP, "Up"}, {VK_RIGHT, "Right"}, {VK_DOWN, "Down"},
+    {VK_SELECT, "Select"}, {VK_PRINT, "Print"}, {VK_EXECUTE, "Execute"},
+    {VK_SNAPSHOT, "PrintScreen"}, {VK_INSERT, "Insert"}, {VK_DELETE, "Delete"}, {VK_HELP, "Help"},
+    {VK_LWIN, "LWin"}, {VK_RWIN, "RWin"}, {VK_APPS, "Apps"},
+    {VK_SLEEP, "Sleep"},
+    {VK_NUMPAD0, "Numpad0"}, {VK_NUMPAD1, "Numpad1"}, {VK_NUMPAD2, "Numpad2"},
+    {VK_NUMPAD3, "Numpad3"}, {VK_NUMPAD4, "Numpad4"}, {VK_NUMPAD5, "Numpad5"},
+    {VK_NUMPAD6, "Numpad6"}, {VK_NUMPAD7, "Numpad7"}, {VK_NUMPAD8, "Numpad8"},
+    {VK_NUMPAD9, "Numpad9"},
+    {VK_MULTIPLY, "NumpadMultiply"}, {VK_ADD, "NumpadAdd"}, {VK_SEPARATOR, "NumpadSeparator"},
+    {VK_SUBTRACT, "NumpadSubtract"}, {VK_DECIMAL, "NumpadDecimal"}, {VK_DIVIDE, "NumpadDivide"},
+    {VK_F1, "F1"}, {VK_F2, "F2"}, {VK_F3, "F3"}, {VK_F4, "F4"}, {VK_F5, "F5"}, {VK_F6, "F6"},
+    {VK_F7, "F7"}, {VK_F8, "F8"}, {VK_F9, "F9"}, {VK_F10, "F10"}, {VK_F11, "F11"}, {VK_F12, "F12"},
+    {VK_NUMLOCK, "NumLock"}, {VK_SCROLL, "ScrollLock"},
+    {VK_LSHIFT, "LShift"}, {VK_RSHIFT, "RShift"},
+    {VK_LCONTROL, "LCtrl"}, {VK_RCONTROL, "RCtrl"},
+    {VK_LMENU, "LAlt"}, {VK_RMENU, "RAlt"},
+    // OEM keys for punctuation
+    {VK_OEM_1, ";"}, {VK_OEM_PLUS, "="}, {VK_OEM_COMMA, ","}, {VK_OEM_MINUS, "-"},
+    {VK_OEM_PERIOD, "."}, {VK_OEM_2, "/"}, {VK_OEM_3, "`"}, {VK_OEM_4, "["},
+    {VK_OEM_5, "\\"}, {VK_OEM_6, "]"}, {VK_OEM_7, "'"},
+    // Alphanumeric keys: the virtual-key code is the ASCII character
+    {'A', "A"}, {'B', "B"}, {'C', "C"}, {'D', "D"}, {'E', "E"}, {'F', "F"}, {'G', "G"},
+    {'H', "H"}, {'I', "I"}, {'J', "J"}, {'K', "K"}, {'L', "L"}, {'M', "M"}, {'N', "N"},
+    {'O', "O"}, {'P', "P"}, {'Q', "Q"}, {'R', "R"}, {'S', "S"}, {'T', "T"}, {'U', "U"},
+    {'V', "V"}, {'W', "W"}, {'X', "X"}, {'Y', "Y"}, {'Z', "Z"},
+    {'0', "0"}, {'1', "1"}, {'2', "2"}, {'3', "3"}, {'4', "4"},
+    {'5', "5"}, {'6', "6"}, {'7', "7"}, {'8', "8"}, {'9', "9"}
+};
+constexpr size_t kCodeSpace = 256;
+
+#elif defined(__APPLE__)
+constexpr KeyTableEntry kPlatformKeyEntries[] = {
+    // Non-printable keys
+    {kVK_Delete, "Backspace"}, {kVK_Tab, "Tab"}, {kVK_Return, "Enter"},
+    {kVK_Shift, "Shift"}, {kVK_Control, "Ctrl"}, {kVK_Option, "Alt"}, // Option is Alt
+    {kVK_Command, "Cmd"},
+    {kVK_RightShift, "RShift"}, {kVK_RightControl, "RCtrl"}, {kVK_RightOption, "RAlt"},
+    {kVK_RightCommand, "RCmd"},
+    {kVK_CapsLock, "CapsLock"},
+    {kVK_Escape, "Esc"}, {kVK_Space, "Space"},
+    {kVK_PageUp, "PageUp"}, {kVK_PageDown, "PageDown"}, {kVK_End, "End"}, {kVK_Home, "Home"},
+    {kVK_LeftArrow, "Left"}, {kVK_UpArrow, "Up"}, {kVK_RightArrow, "Right"}, {kVK_DownArrow, "Down"},
+    {kVK_F1, "F1"}, {kVK_F2, "F2"}, {kVK_F3, "F3"}, {kVK_F4, "F4"}, {kVK_F5, "F5"}, {kVK_F6, "F6"},
+    {kVK_F7, "F7"}, {kVK_F8, "F8"}, {kVK_F9, "F9"}, {kVK_F10, "F10"}, {kVK_F11, "F11"}, {kVK_F12, "F12"},
+    {kVK_ForwardDelete, "Delete"}, {kVK_Help, "Insert"}, // Help is often Insert
+
+    // Printable keys based on US ANSI keyboard layout
+    {kVK_ANSI_A, "a"}, {kVK_ANSI_B, "b"}, {kVK_ANSI_C, "c"}, {kVK_ANSI_D, "d"},
+    {kVK_ANSI_E, "e"}, {kVK_ANSI_F, "f"}, {kVK_ANSI_G, "g"}, {kVK_ANSI_H, "h"},
+    {kVK_ANSI_I, "i"}, {kVK_ANSI_J, "j"}, {kVK_ANSI_K, "k"}, {kVK_ANSI_L, "l"},
+    {kVK_ANSI_M, "m"}, {kVK_ANSI_N, "n"}, {kVK_ANSI_O, "o"}, {kVK_ANSI_P, "p"},
+    {kVK_ANSI_Q, "q"}, {kVK_ANSI_R, "r"}, {kVK_ANSI_S, "s"}, {kVK_ANSI_T, "t"},
+    {kVK_ANSI_U, "u"}, {kVK_ANSI_V, "v"}, {kVK_ANSI_W, "w"}, {kVK_ANSI_X, "x"},
+    {kVK_ANSI_Y, "y"}, {kVK_ANSI_Z, "z"},
+
+    {kVK_ANSI_0, "0"}, {kVK_ANSI_1, "1"}, {kVK_ANSI_2, "2"}, {kVK_ANSI_3, "3"},
+    {kVK_ANSI_4, "4"}, {kVK_ANSI_5, "5"}, {kVK_ANSI_6, "6"}, {kVK_ANSI_7, "7"},
+    {kVK_ANSI_8, "8"}, {kVK_ANSI_9, "9"},
+
+    {kVK_ANSI_Equal, "="}, {kVK_ANSI_Minus, "-"},
+    {kVK_ANSI_LeftBracket, "["}, {kVK_ANSI_RightBracket, "]"},
+    {kVK_ANSI_Backslash, "\\"}, {kVK_ANSI_Semicolon, ";"},
+    {kVK_ANSI_Quote, "'"}, {kVK_ANSI_Comma, ","},
+    {kVK_ANSI_Period, "."}, {kVK_ANSI_Slash, "/"},
+    {kVK_ANSI_Grave, "`"},
+
+    // Name-only aliases: the character forms of Space/Return, uppercase letters
+    {kVK_Space, " ", true}, {kVK_Return, "\n", true}, {kVK_Return, "\r", true},
+    {kVK_ANSI_A, "A", true}, {kVK_ANSI_B, "B", true}, {kVK_ANSI_C, "C", true}, {kVK_ANSI_D, "D", true},
+    {kVK_ANSI_E, "E", true}, {kVK_ANSI_F, "F", true}, {kVK_ANSI_G, "G", true}, {kVK_ANSI_H, "H", true},
+    {kVK_ANSI_I, "I", true}, {kVK_ANSI_J, "J", true}, {kVK_ANSI_K, "K", true}, {kVK_ANSI_L, "L", true},
+    {kVK_ANSI_M, "M", true}, {kVK_ANSI_N, "N", true}, {kVK_ANSI_O, "O", true}, {kVK_ANSI_P, "P", true},
+    {kVK_ANSI_Q, "Q", true}, {kVK_ANSI_R, "R", true}, {kVK_ANSI_S, "S", true}, {kVK_ANSI_T, "T", true},
+    {kVK_ANSI_U, "U", true}, {kVK_ANSI_V, "V", true}, {kVK_ANSI_W, "W", true}, {kVK_ANSI_X, "X", true},
+    {kVK_ANSI_Y, "Y", true}, {kVK_ANSI_Z, "Z", true}
+};
+constexpr size_t kCodeSpace = 128;
+
+#elif defined(__linux__)
+// Names follow the macOS table so recordings move between the two platforms by name
+constexpr KeyTableEntry kPlatformKeyEntries[] = {
+    {KEY_BACKSPACE, "Backspace"}, {KEY_TAB, "Tab"}, {KEY_ENTER, "Enter"},
+    {KEY_LEFTSHIFT, "Shift"}, {KEY_LEFTCTRL, "Ctrl"}, {KEY_LEFTALT, "Alt"},
+    {KEY_LEFTMETA, "Cmd"},
+    {KEY_RIGHTSHIFT, "RShift"}, {KEY_RIGHTCTRL, "RCtrl"}, {KEY_RIGHTALT, "RAlt"},
+    {KEY_RIGHTMETA, "RCmd"},
+    {KEY_CAPSLOCK, "CapsLock"},
+    {KEY_ESC, "Esc"}, {KEY_SPACE, "Space"},
+    {KEY_PAGEUP, "PageUp"}, {KEY_PAGEDOWN, "PageDown"}, {KEY_END, "End"}, {KEY_HOME, "Home"},
+    {KEY_LEFT, "Left"}, {KEY_UP, "Up"}, {KEY_RIGHT, "Right"}, {KEY_DOWN, "Down"},
+    {KEY_F1, "F1"}, {KEY_F2, "F2"}, {KEY_F3, "F3"}, {KEY_F4, "F4"}, {KEY_F5, "F5"}, {KEY_F6, "F6"},
+    {KEY_F7, "F7"}, {KEY_F8, "F8"}, {KEY_F9, "F9"}, {KEY_F10, "F10"}, {KEY_F11, "F11"}, {KEY_F12, "F12"},
+    {KEY_DELETE, "Delete"}, {KEY_INSERT, "Insert"},
+    {KEY_PAUSE, "Pause"}, {KEY_SYSRQ, "PrintScreen"}, {KEY_COMPOSE, "Apps"},
+    {KEY_NUMLOCK, "NumLock"}, {KEY_SCROLLLOCK, "ScrollLock"},
+    {KEY_KP0, "Numpad0"}, {KEY_KP1, "Numpad1"}, {KEY_KP2, "Numpad2"}, {KEY_KP3, "Numpad3"},
+    {KEY_KP4, "Numpad4"}, {KEY_KP5, "Numpad5"}, {KEY_KP6, "Numpad6"}, {KEY_KP7, "Numpad7"},
+    {KEY_KP8, "Numpad8"}, {KEY_KP9, "Numpad9"},
+    {KEY_KPASTERISK, "NumpadMultiply"}, {KEY_KPPLUS, "NumpadAdd"}, {KEY_KPMINUS, "NumpadSubtract"},
+    {KEY_KPDOT, "NumpadDecimal"}, {KEY_KPSLASH, "NumpadDivide"}, {KEY_KPENTER, "NumpadEnter"},
+
+    {KEY_A, "a"}, {KEY_B, "b"}, {KEY_C, "c"}, {KEY_D, "d"}, {KEY_E, "e"}, {KEY_F, "f"},
+    {KEY_G, "g"}, {KEY_H, "h"}, {KEY_I, "i"}, {KEY_J, "j"}, {KEY_K, "k"}, {KEY_L, "l"},
+    {KEY_M, "m"}, {KEY_N, "n"}, {KEY_O, "o"}, {KEY_P, "p"}, {KEY_Q, "q"}, {KEY_R, "r"},
+    {KEY_S, "s"}, {KEY_T, "t"}, {KEY_U, "u"}, {KEY_V, "v"}, {KEY_W, "w"}, {KEY_X, "x"},
+    {KEY_Y, "y"}, {KEY_Z, "z"},
+
+    {KEY_0, "0"}, {KEY_1, "1"}, {KEY_2, "2"}, {KEY_3, "3"}, {KEY_4, "4"},
+    {KEY_5, "5"}, {KEY_6, "6"}, {KEY_7, "7"}, {KEY_8, "8"}, {KEY_9, "9"},
+
+    {KEY_EQUAL, "="}, {KEY_MINUS, "-"},
+    {KEY_LEFTBRACE, "["}, {KEY_RIGHTBRACE, "]"},
+    {KEY_BACKSLASH, "\\"}, {KEY_SEMICOLON, ";"},
+    {KEY_APOSTROPHE, "'"}, {KEY_COMMA, ","},
+    {KEY_DOT, "."}, {KEY_SLASH, "/"},
+    {KEY_GRAVE, "`"},
+
+    // Name-only aliases so Windows recordings resolve too
+    {KEY_SPACE, " ", true}, {KEY_ENTER, "\n", true}, {KEY_ENTER, "\r", true},
+    {KEY_LEFTSHIFT, "LShift", true}, {KEY_LEFTCTRL, "LCtrl", true}, {KEY_LEFTALT, "LAlt", true},
+    {KEY_LEFTMETA, "LWin", true}, {KEY_RIGHTMETA, "RWin", true},
+    {KEY_A, "A", true}, {KEY_B, "B", true}, {KEY_C, "C", true}, {KEY_D, "D", true},
+    {KEY_E, "E", true}, {KEY_F, "F", true}, {KEY_G, "G", true}, {KEY_H, "H", true},
+    {KEY_I, "I", true}, {KEY_J, "J", true}, {KEY_K, "K", true}, {KEY_L, "L", true},
+    {KEY_M, "M", true}, {KEY_N, "N", true}, {KEY_O, "O", true}, {KEY_P, "P", true},
+    {KEY_Q, "Q", true}, {KEY_R, "R", true}, {KEY_S, "S", true}, {KEY_T, "T", true},
+    {KEY_U, "U", true}, {KEY_V, "V", true}, {KEY_W, "W", true}, {KEY_X, "X", true},
+    {KEY_Y, "Y", true}, {KEY_Z, "Z", true}
+};
+constexpr size_t kCodeSpace = 256;
+
+#else
+constexpr KeyTableEntry kPlatformKeyEntries[] = {
+    {0, "Unknown", true}
+};
+constexpr size_t kCodeSpace = 1;
+#endif
+
+constexpr size_t kPlatformKeyCount = sizeof(kPlatformKeyEntries) / sizeof(kPlatformKeyEntries[0]);
+
+// Built by the compiler; nothing runs at static-init time
+constexpr KeyTable<kPlatformKeyCount, kCodeSpace> kPlatformKeys(kPlatformKeyEntries);
+
+} // end anonymous namespace
+
+namespace KeyTables {
+
+std::string_view nameForCode(uint16_t code) {
+    return kPlatformKeys.name(code);
+}
+
+int codeForName(std::string_view name) {
+    return kPlatformKeys.code(name);
+}
+
+size_t size() {
+    return kPlatformKeys.size();
+}
+
+int indexForName(std::string_view name) {
+    return kPlatformKeys.indexForName(name);
+}
+
+const KeyTableEntry& entry(size_t index) {
+    return kPlatformKeys.entry(index);
+}
+
+} // namespace KeyTables
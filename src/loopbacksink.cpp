@@ -0,0 +1,23 @@
+#include "../include/loopbacksink.h"
+
+#include <chrono>
+
+LoopbackSink::LoopbackSink(size_t expectedEvents, bool recordEvents)
+    : m_recordEvents(recordEvents) {
+    if (m_recordEvents) {
+        m_events.reserve(expectedEvents);
+    }
+}
+
+bool LoopbackSink::sendBatch(const KeyEvent* events, size_t count) {
+    m_sentCount += count;
+    if (!m_recordEvents) {
+        return true;
+    }
+    const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    for (size_t i = 0; i < count; ++i) {
+        m_events.push_back(Injected{events[i], nowNs});
+    }
+    return true;
+}
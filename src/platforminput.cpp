@@ -0,0 +1,476 @@
+#include "../include/inputbackend.h"
+#include "../include/keyrecorder.h"
+#include <QDebug>
+#include <QString>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <ApplicationServices/ApplicationServices.h>
+#include <CoreFoundation/CoreFoundation.h>
+#include <mach/mach_time.h>
+#elif defined(__linux__)
+#include "../include/evdevcapture.h"
+#include "../include/uinputkeyboard.h"
+#endif
+
+namespace { // Use an anonymous namespace to limit scope
+
+#ifdef _WIN32
+// Low-level keyboard hook. The hook callback is a plain function pointer, so the
+// active source is reached through a static; only one may be installed at a time.
+class WindowsHookSource : public InputSource {
+public:
+    ~WindowsHookSource() override { stop(); }
+
+    bool start(KeyCallback callback, std::string* error) override {
+        if (m_hook) {
+            return true;
+        }
+        m_callback = std::move(callback);
+        s_active = this;
+
+        // Installed on the calling (GUI) thread, whose message loop services the hook
+        m_hook = SetWindowsHookEx(WH_KEYBOARD_LL, hookProc, GetModuleHandle(NULL), 0);
+        if (!m_hook) {
+            const DWORD code = GetLastError();
+            s_active = nullptr;
+            if (error) *error = "Failed to install keyboard hook. Error code: " + std::to_string(code);
+            return false;
+        }
+        return true;
+    }
+
+    void stop() override {
+        if (!m_hook) {
+            return;
+        }
+        if (!UnhookWindowsHookEx(m_hook)) {
+            qWarning() << "Failed to remove keyboard hook. Error code:" << GetLastError();
+        }
+        m_hook = NULL;
+        s_active = nullptr;
+    }
+
+    bool isRunning() const override { return m_hook != NULL; }
+
+private:
+    static LRESULT CALLBACK hookProc(int nCode, WPARAM wParam, LPARAM lParam) {
+        if (nCode == HC_ACTION && lParam && s_active) {
+            const auto* info = reinterpret_cast<const KBDLLHOOKSTRUCT*>(lParam);
+            const bool isKeyDown = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
+            const bool isKeyUp = (wParam == WM_KEYUP || wParam == WM_SYSKEYUP);
+            if (isKeyDown || isKeyUp) {
+                // KBDLLHOOKSTRUCT::time only has GetTickCount (millisecond) resolution, so
+                // stamp the event with QueryPerformanceCounter (steady_clock) on arrival
+                s_active->m_callback(static_cast<uint16_t>(info->vkCode), isKeyDown, KeyRecorder::nowNs());
+            }
+        }
+        // Always call the next hook in the chain
+        return CallNextHookEx(NULL, nCode, wParam, lParam);
+    }
+
+    static inline WindowsHookSource* s_active = nullptr;
+    HHOOK m_hook = NULL;
+    KeyCallback m_callback;
+};
+
+class SendInputSink : public InputSink {
+public:
+    bool send(const KeyEvent& event) override { return sendBatch(&event, 1); }
+
+    // One SendInput call for the whole batch, so chords reach the input queue together
+    bool sendBatch(const KeyEvent* events, size_t count) override {
+        INPUT inputs[kMaxInputs];
+        bool ok = true;
+        while (count > 0) {
+            UINT filled = 0;
+            const size_t chunk = count < kMaxInputs ? count : kMaxInputs;
+            for (size_t i = 0; i < chunk; ++i) {
+                if (fillInput(events[i], &inputs[filled])) {
+                    ++filled;
+                } else {
+                    ok = false;
+                }
+            }
+            if (filled > 0 && SendInput(filled, inputs, sizeof(INPUT)) != filled) {
+                qDebug() << "SendInputSink: SendInput failed with error code:" << GetLastError()
+                         << "for a batch of" << filled << "events starting with key:"
+                         << QString::fromStdString(KeyNames::name(events[0].keyId));
+                ok = false;
+            }
+            events += chunk;
+            count -= chunk;
+        }
+        return ok;
+    }
+
+    // Resolves extended-key flags and scan codes for the whole sequence up front.
+    // Events that cannot be injected are dropped; m_inputStart maps event indices to
+    // their position in the INPUT tape so batches stay contiguous.
+    bool prepare(const KeyEvent* events, size_t count) override {
+        m_inputs.clear();
+        m_inputs.reserve(count);
+        m_inputStart.assign(count + 1, 0);
+        for (size_t i = 0; i < count; ++i) {
+            m_inputStart[i] = static_cast<uint32_t>(m_inputs.size());
+            INPUT input;
+            if (fillInput(events[i], &input)) {
+                m_inputs.push_back(input);
+            }
+        }
+        m_inputStart[count] = static_cast<uint32_t>(m_inputs.size());
+        return InputSink::prepare(events, count);
+    }
+
+    bool sendPrepared(size_t first, size_t count) override {
+        if (first + count >= m_inputStart.size()) {
+            return false;
+        }
+        const uint32_t begin = m_inputStart[first];
+        const UINT n = m_inputStart[first + count] - begin;
+        if (n == 0) {
+            return false;
+        }
+        if (SendInput(n, &m_inputs[begin], sizeof(INPUT)) != n) {
+            qDebug() << "SendInputSink: SendInput failed with error code:" << GetLastError()
+                     << "for a batch of" << n << "events";
+            return false;
+        }
+        return n == count;
+    }
+
+    void close() override {
+        m_inputs.clear();
+        m_inputStart.clear();
+    }
+
+    const char* name() const override { return "SendInput"; }
+
+private:
+    static constexpr size_t kMaxInputs = 64;
+    std::vector<INPUT> m_inputs;          // Ready-to-send records, one per valid event
+    std::vector<uint32_t> m_inputStart;   // Event index -> first INPUT at or after it
+
+    static bool fillInput(const KeyEvent& event, INPUT* input) {
+        const WORD winKeyCode = static_cast<WORD>(event.code);
+        if (winKeyCode == 0) {
+            qDebug() << "SendInputSink: Invalid key code 0 for key:" << QString::fromStdString(KeyNames::name(event.keyId));
+            return false;
+        }
+
+        *input = INPUT{};
+        input->type = INPUT_KEYBOARD;
+        input->ki.wVk = winKeyCode;
+        if (!event.isDown()) {
+            input->ki.dwFlags = KEYEVENTF_KEYUP;
+        }
+
+        // Special handling for extended keys (e.g., Right Ctrl, Right Alt, Arrow keys, etc.)
+        // See: https://docs.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes
+        if (winKeyCode == VK_RCONTROL || winKeyCode == VK_RMENU ||
+            winKeyCode == VK_INSERT || winKeyCode == VK_DELETE ||
+            winKeyCode == VK_HOME || winKeyCode == VK_END ||
+            winKeyCode == VK_PRIOR || winKeyCode == VK_NEXT || // PageUp, PageDown
+            winKeyCode == VK_LEFT || winKeyCode == VK_UP ||
+            winKeyCode == VK_RIGHT || winKeyCode == VK_DOWN ||
+            winKeyCode == VK_NUMLOCK || winKeyCode == VK_SNAPSHOT /*PrintScreen*/ ||
+            winKeyCode == VK_CANCEL || /* Pause/Break often sends VK_CANCEL */
+            winKeyCode == VK_DIVIDE /* Numpad Divide */)
+        {
+            input->ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+        }
+
+        // Use the scan code when the virtual key is unclear (e.g., certain international keys)
+        if (event.keyId == KeyNames::kUnknown || winKeyCode > 255) {
+            UINT scanCode = MapVirtualKey(winKeyCode, MAPVK_VK_TO_VSC);
+            if (scanCode) {
+                input->ki.wScan = static_cast<WORD>(scanCode);
+                input->ki.dwFlags |= KEYEVENTF_SCANCODE;
+                input->ki.wVk = 0;
+            }
+        }
+        return true;
+    }
+};
+
+#elif defined(__APPLE__)
+// CGEventGetTimestamp is in mach absolute time units (ticks on Apple Silicon, ns on Intel).
+// Converting with the timebase puts it on the same timeline as steady_clock.
+int64_t machTimeToNanoseconds(uint64_t machTime) {
+    static const mach_timebase_info_data_t timebase = [] {
+        mach_timebase_info_data_t info = {0, 0};
+        mach_timebase_info(&info);
+        return info;
+    }();
+    if (timebase.denom == 0) {
+        return static_cast<int64_t>(machTime);
+    }
+    return static_cast<int64_t>((static_cast<__uint128_t>(machTime) * timebase.numer) / timebase.denom);
+}
+
+// Listen-only HID event tap on the calling thread's run loop
+class EventTapSource : public InputSource {
+public:
+    ~EventTapSource() override { stop(); }
+
+    bool start(KeyCallback callback, std::string* error) override {
+        if (m_eventTap) {
+            return true;
+        }
+        m_callback = std::move(callback);
+
+        // Creating the tap is the real permission test: for unsigned apps
+        // AXIsProcessTrusted() can report false even when the tap works
+        const CGEventMask eventMask = (1 << kCGEventKeyDown) | (1 << kCGEventKeyUp);
+        m_eventTap = CGEventTapCreate(kCGHIDEventTap, kCGHeadInsertEventTap,
+                                      kCGEventTapOptionListenOnly, eventMask,
+                                      tapCallback, this);
+        if (!m_eventTap) {
+            if (error) *error = "Failed to create event tap - permissions likely not granted";
+            return false;
+        }
+
+        m_runLoopSource = CFMachPortCreateRunLoopSource(kCFAllocatorDefault, m_eventTap, 0);
+        if (!m_runLoopSource) {
+            CFRelease(m_eventTap);
+            m_eventTap = nullptr;
+            if (error) *error = "Failed to create run loop source for the event tap";
+            return false;
+        }
+
+        m_runLoop = CFRunLoopGetCurrent();
+        CFRunLoopAddSource(m_runLoop, m_runLoopSource, kCFRunLoopCommonModes);
+        CGEventTapEnable(m_eventTap, true);
+        return true;
+    }
+
+    void stop() override {
+        if (!m_eventTap) {
+            return;
+        }
+        CGEventTapEnable(m_eventTap, false);
+        CFRunLoopRemoveSource(m_runLoop, m_runLoopSource, kCFRunLoopCommonModes);
+        CFRelease(m_runLoopSource);
+        m_runLoopSource = nullptr;
+        CFRelease(m_eventTap);
+        m_eventTap = nullptr;
+        m_runLoop = nullptr;
+    }
+
+    bool isRunning() const override { return m_eventTap != nullptr; }
+
+private:
+    static CGEventRef tapCallback([[maybe_unused]] CGEventTapProxy proxy, CGEventType type,
+                                  CGEventRef event, void* refcon) {
+        auto* self = static_cast<EventTapSource*>(refcon);
+
+        // The system disables slow taps; turn it straight back on
+        if (type == kCGEventTapDisabledByTimeout || type == kCGEventTapDisabledByUserInput) {
+            if (self->m_eventTap) {
+                CGEventTapEnable(self->m_eventTap, true);
+            }
+            return event;
+        }
+
+        if (type == kCGEventKeyDown || type == kCGEventKeyUp) {
+            const auto keyCode = static_cast<uint16_t>(CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode));
+            // Use the time the HID system saw the key, not the time this callback ran
+            self->m_callback(keyCode, type == kCGEventKeyDown, machTimeToNanoseconds(CGEventGetTimestamp(event)));
+        }
+
+        // We are just observing, pass the event along
+        return event;
+    }
+
+    CFMachPortRef m_eventTap = nullptr;
+    CFRunLoopSourceRef m_runLoopSource = nullptr;
+    CFRunLoopRef m_runLoop = nullptr;
+    KeyCallback m_callback;
+};
+
+class CGEventSink : public InputSink {
+public:
+    ~CGEventSink() override { close(); }
+
+    // One event source per session instead of one per keystroke
+    bool open(std::string* error) override {
+        if (!m_source) {
+            m_source = CGEventSourceCreate(kCGEventSourceStateHIDSystemState);
+        }
+        if (!m_source) {
+            if (error) *error = "Failed to create event source";
+            return false;
+        }
+        return true;
+    }
+
+    void close() override {
+        releasePrepared();
+        if (m_source) {
+            CFRelease(m_source);
+            m_source = nullptr;
+        }
+    }
+
+    // Creates every CGEvent before playback; posting is all that is left per batch
+    bool prepare(const KeyEvent* events, size_t count) override {
+        releasePrepared();
+        m_prepared.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_prepared.push_back(CGEventCreateKeyboardEvent(m_source, static_cast<CGKeyCode>(events[i].code), events[i].isDown()));
+        }
+        return InputSink::prepare(events, count);
+    }
+
+    bool sendPrepared(size_t first, size_t count) override {
+        if (first + count > m_prepared.size()) {
+            return false;
+        }
+        bool ok = true;
+        const CGEventTimestamp now = mach_absolute_time();
+        for (size_t i = first; i < first + count; ++i) {
+            if (!m_prepared[i]) {
+                ok = false;
+                continue;
+            }
+            // Events are reused across repetitions; stamp them with the post time
+            CGEventSetTimestamp(m_prepared[i], now);
+            CGEventPost(kCGHIDEventTap, m_prepared[i]);
+        }
+        return ok;
+    }
+
+    // No batch API on macOS: the default sendBatch posts each event, reusing m_source
+    bool send(const KeyEvent& event) override {
+        CGEventRef cgEvent = CGEventCreateKeyboardEvent(m_source, static_cast<CGKeyCode>(event.code), event.isDown());
+        if (cgEvent == NULL) {
+            qDebug() << "CGEventSink: Failed to create keyboard event for key:" << QString::fromStdString(KeyNames::name(event.keyId));
+            return false;
+        }
+        CGEventPost(kCGHIDEventTap, cgEvent);
+        CFRelease(cgEvent);
+        return true;
+    }
+
+    const char* name() const override { return "CGEvent"; }
+
+private:
+    void releasePrepared() {
+        for (CGEventRef event : m_prepared) {
+            if (event) CFRelease(event);
+        }
+        m_prepared.clear();
+    }
+
+    CGEventSourceRef m_source = nullptr;
+    std::vector<CGEventRef> m_prepared;
+};
+
+#elif defined(__linux__)
+class UinputSink : public InputSink {
+public:
+    // Create the virtual keyboard once for the whole session. Doing it before the
+    // preroll gives the display server time to pick up the new device; settleTime()
+    // makes sure the engine waits that long even with no preroll.
+    bool open(std::string* error) override {
+        if (!m_keyboard.open(error)) {
+            return false;
+        }
+        qDebug() << "UinputSink: virtual keyboard at" << QString::fromStdString(m_keyboard.devicePath());
+        return true;
+    }
+
+    void close() override {
+        m_keyboard.close();
+        m_tape.clear();
+    }
+
+    // The whole sequence as EV_KEY records; a batch is one contiguous slice of it
+    bool prepare(const KeyEvent* events, size_t count) override {
+        m_tape.clear();
+        m_tape.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_tape.push_back(UinputKeyboard::keyEvent(events[i].code, events[i].isDown()));
+        }
+        return InputSink::prepare(events, count);
+    }
+
+    bool sendPrepared(size_t first, size_t count) override {
+        if (first + count > m_tape.size()) {
+            return false;
+        }
+        if (!m_keyboard.sendEvents(&m_tape[first], count)) {
+            qDebug() << "UinputSink: uinput write failed for a batch of" << count << "events";
+            return false;
+        }
+        return true;
+    }
+
+    bool send(const KeyEvent& event) override { return sendBatch(&event, 1); }
+
+    // The whole batch as EV_KEY events followed by one SYN_REPORT, in a single write
+    bool sendBatch(const KeyEvent* events, size_t count) override {
+        if (!m_keyboard.isOpen()) {
+            return false;
+        }
+        uint16_t codes[kMaxBatch];
+        bool down[kMaxBatch];
+        bool ok = true;
+        while (count > 0) {
+            const size_t chunk = count < kMaxBatch ? count : kMaxBatch;
+            for (size_t i = 0; i < chunk; ++i) {
+                codes[i] = events[i].code;
+                down[i] = events[i].isDown();
+            }
+            if (!m_keyboard.send(codes, down, chunk)) {
+                qDebug() << "UinputSink: uinput write failed for a batch of" << chunk
+                         << "events starting with key:" << QString::fromStdString(KeyNames::name(events[0].keyId));
+                ok = false;
+            }
+            events += chunk;
+            count -= chunk;
+        }
+        return ok;
+    }
+
+    std::chrono::microseconds settleTime() const override { return UinputKeyboard::kSettleTime; }
+
+    const char* name() const override { return "uinput"; }
+
+private:
+    static constexpr size_t kMaxBatch = 64;
+    UinputKeyboard m_keyboard;
+    std::vector<input_event> m_tape;
+};
+#endif
+
+} // end anonymous namespace
+
+std::unique_ptr<InputSource> createPlatformSource() {
+#ifdef _WIN32
+    return std::make_unique<WindowsHookSource>();
+#elif defined(__APPLE__)
+    return std::make_unique<EventTapSource>();
+#elif defined(__linux__)
+    return std::make_unique<EvdevCapture>();
+#else
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<InputSink> createPlatformSink() {
+#ifdef _WIN32
+    return std::make_unique<SendInputSink>();
+#elif defined(__APPLE__)
+    return std::make_unique<CGEventSink>();
+#elif defined(__linux__)
+    return std::make_unique<UinputSink>();
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,60 @@
+#include "../include/playbackclock.h"
+#include <thread>
+
+void PlaybackClock::setSpinThreshold(std::chrono::microseconds threshold) {
+    m_spinThresholdUs = (threshold.count() < 0) ? 0 : threshold.count();
+}
+
+std::chrono::microseconds PlaybackClock::spinThreshold() const {
+    return std::chrono::microseconds(m_spinThresholdUs.load());
+}
+
+bool PlaybackClock::sleepUntil(TimePoint deadline) {
+    // Coarse phase: block on the condition variable while we are comfortably early,
+    // so interrupt() can cut the wait short no matter how long the delay is
+    const TimePoint spinStart = deadline - spinThreshold();
+    if (Clock::now() < spinStart) {
+        std::unique_lock<std::mutex> lock(m_waitMutex);
+        if (m_waitCondition.wait_until(lock, spinStart, [this] { return isInterrupted(); })) {
+            return false;
+        }
+    }
+
+    // Fine phase: spin for the last stretch, where OS sleep granularity would overshoot
+    while (Clock::now() < deadline) {
+        if (isInterrupted()) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return !isInterrupted();
+}
+
+void PlaybackClock::interrupt() {
+    {
+        // Take the lock so the flag cannot flip between the waiter's predicate check and its wait
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_interrupted.store(true, std::memory_order_release);
+    }
+    m_waitCondition.notify_all();
+}
+
+void PlaybackClock::clearInterrupt() {
+    std::lock_guard<std::mutex> lock(m_waitMutex);
+    m_interrupted.store(false, std::memory_order_release);
+}
+
+void PlaybackClock::resetStats() {
+    m_worstLateness = std::chrono::microseconds(0);
+    m_missedDeadlines = 0;
+}
+
+void PlaybackClock::recordLateness(TimePoint deadline, TimePoint actual) {
+    auto lateness = std::chrono::duration_cast<std::chrono::microseconds>(actual - deadline);
+    if (lateness > m_worstLateness) {
+        m_worstLateness = lateness;
+    }
+    if (lateness > kMissTolerance) {
+        ++m_missedDeadlines;
+    }
+}
@@ -0,0 +1,324 @@
+#include "../include/playbackengine.h"
+
+#include <algorithm>
+
+PlaybackEngine::Report PlaybackEngine::run(const std::vector<KeyEvent>& events, int repeatCount,
+                                           InputSink& sink, size_t startEvent) {
+    // An armed run keeps any stop(), pause() or seek made since arm(); only an unarmed one
+    // resets them here. stop() clears the flag before interrupting, so clearing the
+    // interrupt first means a stop() from now on is never missed.
+    m_clock.clearInterrupt();
+    const bool armed = m_armed.exchange(false);
+    if (!armed) {
+        m_running = true;
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_pauseRequested = false;
+        m_seekRequested = false;
+    }
+    m_paused = false;
+    m_passesCompleted.store(0, std::memory_order_relaxed);
+    m_clock.resetStats();
+
+    Report report;
+    bool interrupted = false;
+    if (!m_running) {
+        // Stopped between arm() and now; nothing has been sent
+        return report;
+    }
+
+    // Everything that does not depend on the clock happens here, before the origin:
+    // batching and offsets in the tape, native input records in the sink
+    const PlaybackTape tape = PlaybackTape::compile(events, timing(), batchThreshold(), kMaxBatchSize);
+    report.passDurationUs = tape.durationUs;
+    if (events.empty()) {
+        // Nothing to schedule; an endless loop over no events would never wait
+        m_running = false;
+        report.completed = true;
+        return report;
+    }
+    if (!sink.prepare(events.data(), events.size())) {
+        m_running = false;
+        report.sendFailures = events.size();
+        return report;
+    }
+
+    // Raise the thread and lock memory only once the tape and native records exist,
+    // so everything the timed loop touches is resident before the first deadline
+    const RealtimeOptions realtimeOptions = realtime();
+    const RealtimeScope realtimeScope(realtimeOptions);
+    if (realtimeOptions.enabled) {
+        RealtimeScope::prefault(events.data(), events.size() * sizeof(KeyEvent));
+        RealtimeScope::prefault(tape.batches.data(), tape.batches.size() * sizeof(PlaybackTape::Batch));
+        RealtimeScope::prefault(tape.eventOffsetsUs.data(), tape.eventOffsetsUs.size() * sizeof(int64_t));
+    }
+    report.threadMode = realtimeScope.mode();
+    report.threadWarnings = realtimeScope.warnings();
+
+    // A seek made while armed picks the start event, keeping the preroll; a pause is
+    // applied once the start position is set up
+    size_t firstEvent = startEvent < events.size() ? startEvent : 0;
+    bool pausePending = false;
+    if (armed) {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        if (m_seekRequested) {
+            m_seekRequested = false;
+            firstEvent = m_seekByIndex
+                ? std::min(m_seekEvent, events.size())
+                : tape.eventAtOffset(std::clamp<int64_t>(m_seekOffsetUs, 0, tape.durationUs));
+        }
+        pausePending = m_pauseRequested;
+    }
+
+    // Every deadline is measured from this origin rather than from the previous event,
+    // so sleep overshoot and injection cost do not accumulate across the sequence.
+    report.origin = PlaybackClock::Clock::now();
+    m_position.store(firstEvent, std::memory_order_relaxed);
+    report.preroll = std::max(std::chrono::microseconds(m_prerollUs.load()), sink.settleTime());
+    RunState state{events, tape, sink, report.origin + report.preroll, 0, {}};
+
+    if (firstEvent >= events.size()) {
+        // Seeked to the end before the start: the first pass has nothing left to play
+        state.nextEvent = events.size();
+    } else if (firstEvent > 0) {
+        // Start mid-sequence: the start event fires after the preroll
+        state.nextEvent = firstEvent;
+        state.passStart -= std::chrono::microseconds(tape.eventOffsetsUs[firstEvent]);
+        state.held = tape.heldBefore(events, firstEvent);
+        sendKeyChanges(state, state.held, true);
+    }
+    if (pausePending && !handleControl(state)) {
+        interrupted = true;
+    }
+
+    // Each pass starts a fixed period after the previous one on the same timeline, so the
+    // loop boundary adds no drift however many passes are played
+    const std::chrono::microseconds passPeriod =
+        std::chrono::microseconds(tape.durationUs) + std::max(repeatGap(), std::chrono::microseconds(0));
+    const bool forever = repeatCount <= kRepeatForever;
+
+    for (uint64_t pass = 0; (forever || pass < static_cast<uint64_t>(repeatCount)) && !interrupted; ++pass) {
+        if (pass > 0) {
+            state.passStart += passPeriod;
+            state.nextEvent = 0;
+        }
+
+        // A seek to the end (or past it) leaves nextEvent == events.size(), which ends the pass
+        size_t b = tape.batchContaining(state.nextEvent);
+        while (state.nextEvent < events.size()) {
+            // After a seek the first batch may be entered part way through
+            const PlaybackTape::Batch& batch = tape.batches[b];
+            const size_t first = std::max<size_t>(batch.first, state.nextEvent);
+            const size_t count = batch.first + batch.count - first;
+            const PlaybackClock::TimePoint deadline =
+                state.passStart + std::chrono::microseconds(tape.eventOffsetsUs[first]);
+
+            // The wait returns early if stop(), pause() or a seek interrupts it
+            if (!m_clock.sleepUntil(deadline) || !m_running) {
+                if (!m_running || !handleControl(state)) {
+                    interrupted = true;
+                    break;
+                }
+                b = tape.batchContaining(state.nextEvent);
+                continue;
+            }
+
+            m_clock.recordLateness(deadline, PlaybackClock::Clock::now());
+            if (sink.sendPrepared(first, count)) {
+                report.eventsSent += count;
+            } else {
+                report.sendFailures += count;
+            }
+            ++report.batches;
+
+            for (size_t i = first; i < first + count; ++i) {
+                state.held.set(events[i].code, events[i].isDown());
+            }
+            state.nextEvent = first + count;
+            m_position.store(state.nextEvent, std::memory_order_relaxed);
+            ++b;
+        }
+
+        if (!interrupted) {
+            report.passes = pass + 1;
+            m_passesCompleted.store(report.passes, std::memory_order_relaxed);
+            if (m_passCallback) {
+                m_passCallback(report.passes);
+            }
+        }
+    }
+
+    // Never leave a key stuck down, whatever ended the run
+    if (!m_paused) {
+        sendKeyChanges(state, state.held, false);
+    }
+
+    m_running = false;
+    m_paused = false;
+    report.worstLateness = m_clock.worstLateness();
+    report.missedDeadlines = m_clock.missedDeadlines();
+    report.completed = !interrupted;
+    return report;
+}
+
+bool PlaybackEngine::handleControl(RunState& state) {
+    std::unique_lock<std::mutex> lock(m_controlMutex);
+    // Cleared under the lock: a request made after this point interrupts again
+    m_clock.clearInterrupt();
+
+    bool paused = m_paused;
+    PlaybackClock::TimePoint pauseStart = PlaybackClock::Clock::now();
+
+    for (;;) {
+        if (!m_running) {
+            return false;
+        }
+
+        if (m_seekRequested) {
+            m_seekRequested = false;
+            const std::vector<int64_t>& offsets = state.tape.eventOffsetsUs;
+            if (m_seekByIndex) {
+                // offsets.size() itself is a valid target: the end of the pass
+                const size_t target = std::min(m_seekEvent, offsets.size());
+                seekTo(state, target, target < offsets.size() ? offsets[target] : state.tape.durationUs, !paused);
+            } else {
+                const int64_t offsetUs = std::clamp<int64_t>(m_seekOffsetUs, 0, state.tape.durationUs);
+                seekTo(state, state.tape.eventAtOffset(offsetUs), offsetUs, !paused);
+            }
+            // While paused, the resume shift is measured from the seek
+            pauseStart = PlaybackClock::Clock::now();
+        }
+
+        if (m_pauseRequested && !paused) {
+            paused = true;
+            m_paused = true;
+            pauseStart = PlaybackClock::Clock::now();
+            sendKeyChanges(state, state.held, false);
+        } else if (!m_pauseRequested && paused) {
+            paused = false;
+            m_paused = false;
+            state.passStart += PlaybackClock::Clock::now() - pauseStart;
+            sendKeyChanges(state, state.held, true);
+        }
+
+        if (!paused) {
+            return true;
+        }
+
+        m_controlCondition.wait(lock, [this] {
+            return !m_running || !m_pauseRequested || m_seekRequested;
+        });
+    }
+}
+
+void PlaybackEngine::seekTo(RunState& state, size_t target, int64_t offsetUs, bool keysLive) {
+    const HeldKeySet targetHeld = state.tape.heldBefore(state.events, target);
+    if (keysLive) {
+        sendKeyChanges(state, state.held & ~targetHeld, false);
+        sendKeyChanges(state, targetHeld & ~state.held, true);
+    }
+    state.held = targetHeld;
+
+    // Re-anchor the pass so the seek position is "now"
+    state.nextEvent = target;
+    state.passStart = PlaybackClock::Clock::now() - std::chrono::microseconds(offsetUs);
+    m_position.store(target, std::memory_order_relaxed);
+}
+
+void PlaybackEngine::sendKeyChanges(RunState& state, const HeldKeySet& keys, bool isDown) {
+    if (keys.none()) {
+        return;
+    }
+    std::vector<KeyEvent> changes;
+    for (size_t code = 0; code < keys.size(); ++code) {
+        if (keys.test(code)) {
+            const auto it = state.tape.keyIds.find(static_cast<uint16_t>(code));
+            const uint16_t keyId = it != state.tape.keyIds.end() ? it->second : KeyNames::kUnknown;
+            changes.emplace_back(keyId, static_cast<uint16_t>(code), isDown, 0);
+        }
+    }
+    state.sink.sendBatch(changes.data(), changes.size());
+}
+
+void PlaybackEngine::setTiming(const PlaybackTiming& timing) {
+    std::lock_guard<std::mutex> lock(m_timingMutex);
+    m_timing = timing;
+}
+
+PlaybackTiming PlaybackEngine::timing() const {
+    std::lock_guard<std::mutex> lock(m_timingMutex);
+    return m_timing;
+}
+
+void PlaybackEngine::setRealtime(const RealtimeOptions& options) {
+    std::lock_guard<std::mutex> lock(m_timingMutex);
+    m_realtime = options;
+}
+
+RealtimeOptions PlaybackEngine::realtime() const {
+    std::lock_guard<std::mutex> lock(m_timingMutex);
+    return m_realtime;
+}
+
+void PlaybackEngine::pause() {
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_pauseRequested = true;
+    }
+    m_clock.interrupt();
+}
+
+void PlaybackEngine::resume() {
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_pauseRequested = false;
+    }
+    m_controlCondition.notify_all();
+}
+
+void PlaybackEngine::seekToEvent(size_t eventIndex) {
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_seekRequested = true;
+        m_seekByIndex = true;
+        m_seekEvent = eventIndex;
+    }
+    m_clock.interrupt();
+    m_controlCondition.notify_all();
+}
+
+void PlaybackEngine::seekToTime(std::chrono::microseconds offset) {
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_seekRequested = true;
+        m_seekByIndex = false;
+        m_seekOffsetUs = offset.count();
+    }
+    m_clock.interrupt();
+    m_controlCondition.notify_all();
+}
+
+void PlaybackEngine::arm() {
+    {
+        // Requests left over from an earlier run do not carry into this one
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_pauseRequested = false;
+        m_seekRequested = false;
+    }
+    m_running = true;
+    m_armed = true;
+}
+
+void PlaybackEngine::disarm() {
+    m_armed = false;
+    m_running = false;
+}
+
+void PlaybackEngine::stop() {
+    m_running = false;
+    {
+        // Taking the lock orders this with a paused handleControl() about to wait
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+    }
+    m_controlCondition.notify_all();
+    m_clock.interrupt();
+}
@@ -0,0 +1,115 @@
+#include "../include/playbacktape.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace { // Use an anonymous namespace to limit scope
+
+int64_t applyGapRules(int64_t gapUs, const PlaybackTiming& timing) {
+    if (timing.idleThresholdUs > 0 && gapUs > timing.idleThresholdUs) {
+        gapUs = std::max<int64_t>(0, timing.idleGapUs);
+    }
+    if (timing.maxGapUs > 0) {
+        gapUs = std::min(gapUs, timing.maxGapUs);
+    }
+    return gapUs;
+}
+
+int64_t applySpeed(int64_t offsetUs, const PlaybackTiming& timing) {
+    if (timing.speed > 0.0 && timing.speed != 1.0) {
+        return std::llround(static_cast<double>(offsetUs) / timing.speed);
+    }
+    return offsetUs;
+}
+
+} // end anonymous namespace
+
+PlaybackTape PlaybackTape::compile(const std::vector<KeyEvent>& events, const PlaybackTiming& timing,
+                                   std::chrono::microseconds batchThreshold, size_t maxBatch) {
+    PlaybackTape tape;
+    tape.eventCount = events.size();
+    tape.eventOffsetsUs.reserve(events.size());
+    tape.batches.reserve(events.size());
+
+    // Offset of each key's pending press, for the minimum hold rule
+    std::unordered_map<uint16_t, int64_t> pressOffsets;
+    std::vector<uint16_t> held;  // Rarely more than a handful of keys
+
+    int64_t offsetUs = 0;
+    // The speed scales the running total, not each gap, so rounding never accumulates
+    int64_t unscaledUs = 0;
+    int64_t scaledUs = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const KeyEvent& event = events[i];
+        if (i % kCheckpointInterval == 0) {
+            tape.heldCheckpoints.push_back(held);
+        }
+        const auto heldIt = std::find(held.begin(), held.end(), event.code);
+        if (event.isDown() && heldIt == held.end()) {
+            held.push_back(event.code);
+        } else if (!event.isDown() && heldIt != held.end()) {
+            held.erase(heldIt);
+        }
+        tape.keyIds.emplace(event.code, event.keyId);
+
+        unscaledUs += applyGapRules(event.delayUs, timing);
+        const int64_t nextScaledUs = applySpeed(unscaledUs, timing);
+        offsetUs += nextScaledUs - scaledUs;
+        scaledUs = nextScaledUs;
+
+        if (timing.minHoldUs > 0) {
+            if (event.isDown()) {
+                pressOffsets[event.code] = offsetUs;
+            } else if (const auto it = pressOffsets.find(event.code); it != pressOffsets.end()) {
+                // Delaying the release pushes everything after it back by the same amount
+                offsetUs = std::max(offsetUs, it->second + timing.minHoldUs);
+                pressOffsets.erase(it);
+            }
+        }
+        tape.eventOffsetsUs.push_back(offsetUs);
+    }
+
+    // Followers go out with their batch's first event; their own offsets stay recorded
+    const int64_t thresholdUs = batchThreshold.count();
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (!tape.batches.empty()) {
+            Batch& last = tape.batches.back();
+            if (last.count < maxBatch && tape.eventOffsetsUs[i] - last.offsetUs <= thresholdUs) {
+                ++last.count;
+                continue;
+            }
+        }
+        tape.batches.push_back(Batch{tape.eventOffsetsUs[i], static_cast<uint32_t>(i), 1});
+    }
+
+    tape.durationUs = offsetUs;
+    return tape;
+}
+
+size_t PlaybackTape::eventAtOffset(int64_t offsetUs) const {
+    return static_cast<size_t>(std::lower_bound(eventOffsetsUs.begin(), eventOffsetsUs.end(), offsetUs)
+                               - eventOffsetsUs.begin());
+}
+
+size_t PlaybackTape::batchContaining(size_t eventIndex) const {
+    const auto it = std::upper_bound(batches.begin(), batches.end(), eventIndex,
+                                     [](size_t index, const Batch& batch) { return index < batch.first; });
+    return it == batches.begin() ? 0 : static_cast<size_t>(it - batches.begin()) - 1;
+}
+
+HeldKeySet PlaybackTape::heldBefore(const std::vector<KeyEvent>& events, size_t eventIndex) const {
+    HeldKeySet held;
+    if (heldCheckpoints.empty()) {
+        return held;
+    }
+    eventIndex = std::min(eventIndex, events.size());
+    const size_t checkpoint = std::min(eventIndex / kCheckpointInterval, heldCheckpoints.size() - 1);
+    for (uint16_t code : heldCheckpoints[checkpoint]) {
+        held.set(code);
+    }
+    for (size_t i = checkpoint * kCheckpointInterval; i < eventIndex; ++i) {
+        held.set(events[i].code, events[i].isDown());
+    }
+    return held;
+}
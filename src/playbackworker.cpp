@@ -1,153 +1,132 @@
 #include "../include/playbackworker.h"
 #include <QDebug>
-#include <chrono>
 
-#ifdef _WIN32
-// Make sure windows.h is included via playbackworker.h or here if needed directly
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-#include <windows.h>
-#endif
+PlaybackWorker::PlaybackWorker(QObject *parent, std::unique_ptr<InputSink> sink)
+    : QObject(parent), m_sink(sink ? std::move(sink) : createPlatformSink()) {}
 
-PlaybackWorker::PlaybackWorker(QObject *parent)
-    : QObject(parent) {}
+PlaybackWorker::~PlaybackWorker() = default;
 
-void PlaybackWorker::doWork(const std::vector<KeyEvent>& sequence, int repeatCount) {
-    m_running = true;
+void PlaybackWorker::doWork(const SequenceSnapshot& sequence, int repeatCount) {
     qDebug() << "PlaybackWorker started in thread:" << QThread::currentThread() 
-             << "with repeat count:" << repeatCount;
+             << "with repeat count:" << repeatCount
+             << "spin threshold (us):" << m_engine.spinThreshold().count()
+             << "batch threshold (us):" << m_engine.batchThreshold().count();
+
+    const PlaybackTiming timing = m_engine.timing();
+    if (!timing.isIdentity()) {
+        qDebug() << "PlaybackWorker timing: speed" << timing.speed
+                 << "max gap (us):" << timing.maxGapUs
+                 << "idle threshold/gap (us):" << timing.idleThresholdUs << timing.idleGapUs
+                 << "min hold (us):" << timing.minHoldUs;
+    }
 
-    // Add a small initial delay to ensure the target application has focus
-    QThread::msleep(300);
-    if (!m_running) {
-        qDebug() << "PlaybackWorker stopped during initial delay.";
-        emit finished();
+    if (!m_sink) {
+        qDebug() << "PlaybackWorker: Key emulation not supported on this platform.";
+        m_engine.disarm();
+        emit timingReport(0, 0, 0);
+        emit finished("Key emulation is not supported on this platform.");
         return;
     }
 
-    // Loop for the requested number of repetitions
-    for (int rep = 0; rep < repeatCount && m_running; rep++) {
-        if (rep > 0) {
-            // Add a small pause between repetitions
-            QThread::msleep(500);
-            if (!m_running) break;
-        }
-        
-        qDebug() << "Playing repetition" << (rep + 1) << "of" << repeatCount;
-        
-        // Play the sequence
-        for (const auto& event : sequence) {
-            if (!m_running) {
-                qDebug() << "PlaybackWorker stopping early.";
-                break;
-            }
-    
-            // Use QThread::msleep for delays in the worker thread
-            // Ensure delay is non-negative
-            long long delay = event.delay;
-            if (delay > 0) {
-                QThread::msleep(static_cast<unsigned long>(delay));
-            }
-    
-            // Check again after sleep in case stopWork was called during msleep
-            if (!m_running) {
-                qDebug() << "PlaybackWorker stopping early after delay.";
-                break;
-            }
-    
-            emulate_key_press(event);
+    // Without a working backend every batch would fail, forever when looping
+    std::string sinkError;
+    if (!m_sink->open(&sinkError)) {
+        const QString error = QString("The %1 key injection backend could not be opened: %2")
+                                  .arg(QString::fromUtf8(m_sink->name()), QString::fromStdString(sinkError));
+        qWarning() << "PlaybackWorker:" << error;
+        m_engine.disarm();
+        emit timingReport(0, 0, 0);
+        emit finished(error);
+        return;
+    }
+
+    // Rate over the last reporting interval, so a long soak shows its current pace
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point lastReport = Clock::now();
+    uint64_t lastPasses = 0;
+    m_engine.setPassCallback([this, &lastReport, &lastPasses](uint64_t passes) {
+        const Clock::time_point now = Clock::now();
+        if (now - lastReport < kProgressInterval) {
+            return;
         }
+        const double seconds = std::chrono::duration<double>(now - lastReport).count();
+        emit passProgress(passes, static_cast<double>(passes - lastPasses) / seconds);
+        lastReport = now;
+        lastPasses = passes;
+    });
+
+    const PlaybackEngine::Report report = m_engine.run(*sequence, repeatCount, *m_sink);
+    m_engine.setPassCallback(nullptr);
+    m_sink->close();
+
+    if (!report.completed) {
+        qDebug() << "PlaybackWorker stopping early.";
+    }
+    const qint64 worstLatenessUs = report.worstLateness.count();
+    qDebug() << "PlaybackWorker finished processing sequence with" << report.passes << "of"
+             << (repeatCount <= PlaybackEngine::kRepeatForever ? QString("unlimited") : QString::number(repeatCount))
+             << "repetitions."
+             << "Sent:" << report.eventsSent << "in" << report.batches << "batches, failed:" << report.sendFailures
+             << "Pass duration (us):" << report.passDurationUs
+             << "Worst lateness (us):" << worstLatenessUs
+             << "Missed deadlines:" << report.missedDeadlines
+             << "Thread mode:" << QString::fromStdString(report.threadMode);
+    if (!report.threadWarnings.empty()) {
+        qWarning() << "PlaybackWorker: low-latency mode incomplete:" << QString::fromStdString(report.threadWarnings);
     }
+    emit passProgress(report.passes, 0.0);
+    emit timingReport(worstLatenessUs, report.missedDeadlines, report.sendFailures);
+    emit finished(QString()); // Signal completion
+}
 
-    // Ensure m_running is reset regardless of loop break reason
-    m_running = false;
-    qDebug() << "PlaybackWorker finished processing sequence with" << repeatCount << "repetitions.";
-    emit finished(); // Signal completion
+void PlaybackWorker::setSpinThreshold(std::chrono::microseconds threshold) {
+    m_engine.setSpinThreshold(threshold);
 }
 
-void PlaybackWorker::stopWork() {
-    qDebug() << "PlaybackWorker requested to stop.";
-    m_running = false; // Set the flag to stop the loop in doWork
+void PlaybackWorker::setBatchThreshold(std::chrono::microseconds threshold) {
+    m_engine.setBatchThreshold(threshold);
 }
 
-void PlaybackWorker::emulate_key_press(const KeyEvent& event) {
-#ifdef __APPLE__
-    // macOS implementation using CGEvent (existing code)
-    CGEventSourceRef source = CGEventSourceCreate(kCGEventSourceStateHIDSystemState);
-    if (source == NULL) {
-        qDebug() << "PlaybackWorker: Failed to create event source";
-        return;
-    }
+void PlaybackWorker::setTiming(const PlaybackTiming& timing) {
+    m_engine.setTiming(timing);
+}
 
-    bool isDown = (event.state == "down");
-    CGEventRef cgEvent = CGEventCreateKeyboardEvent(source, event.macKeyCode, isDown);
-    if (cgEvent == NULL) {
-        qDebug() << "PlaybackWorker: Failed to create keyboard event for key:" << QString::fromStdString(event.key);
-        CFRelease(source);
-        return;
-    }
+void PlaybackWorker::setPreroll(std::chrono::microseconds preroll) {
+    m_engine.setPreroll(preroll);
+}
 
-    CGEventPost(kCGHIDEventTap, cgEvent);
-    CFRelease(cgEvent);
-    CFRelease(source);
+void PlaybackWorker::setRealtime(const RealtimeOptions& options) {
+    m_engine.setRealtime(options);
+}
 
-    // qDebug() << "PlaybackWorker: Emulated (macOS)" << QString::fromStdString(event.key) << event.state;
+void PlaybackWorker::setRepeatGap(std::chrono::microseconds gap) {
+    m_engine.setRepeatGap(gap);
+}
 
-#elif defined(_WIN32)
-    // Windows implementation using SendInput
-    if (event.winKeyCode == 0) {
-        qDebug() << "PlaybackWorker (Win): Invalid key code 0 for key:" << QString::fromStdString(event.key);
-        return;
-    }
+void PlaybackWorker::armWork() {
+    m_engine.arm();
+}
 
-    INPUT input = {0}; // Use = {0} to zero-initialize
-    input.type = INPUT_KEYBOARD;
-    input.ki.wVk = event.winKeyCode;
+void PlaybackWorker::stopWork() {
+    qDebug() << "PlaybackWorker requested to stop.";
+    m_engine.stop(); // Wake the pending wait instead of letting it run out
+}
 
-    // Set KEYEVENTF_KEYUP for key release
-    if (event.state == "up") {
-        input.ki.dwFlags = KEYEVENTF_KEYUP;
-    }
+void PlaybackWorker::pauseWork() {
+    qDebug() << "PlaybackWorker requested to pause at event" << m_engine.position();
+    m_engine.pause(); // Held keys are released until resumeWork
+}
 
-    // Special handling for extended keys (e.g., Right Ctrl, Right Alt, Arrow keys, etc.)
-    // See: https://docs.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes
-    if (event.winKeyCode == VK_RCONTROL || event.winKeyCode == VK_RMENU ||
-        event.winKeyCode == VK_INSERT || event.winKeyCode == VK_DELETE ||
-        event.winKeyCode == VK_HOME || event.winKeyCode == VK_END ||
-        event.winKeyCode == VK_PRIOR || event.winKeyCode == VK_NEXT || // PageUp, PageDown
-        event.winKeyCode == VK_LEFT || event.winKeyCode == VK_UP ||
-        event.winKeyCode == VK_RIGHT || event.winKeyCode == VK_DOWN ||
-        event.winKeyCode == VK_NUMLOCK || event.winKeyCode == VK_SNAPSHOT /*PrintScreen*/ ||
-        event.winKeyCode == VK_CANCEL || /* Pause/Break often sends VK_CANCEL */ 
-        event.winKeyCode == VK_DIVIDE /* Numpad Divide */)
-    {
-        input.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
-    }
+void PlaybackWorker::resumeWork() {
+    qDebug() << "PlaybackWorker requested to resume.";
+    m_engine.resume();
+}
 
-    // For some special keys, we might need to use scan codes instead of virtual key codes
-    // Use scan code if vkCode is unclear (e.g., certain international keys)
-    if (event.key == "Unknown" || event.winKeyCode > 255) {
-        // Try using scan code if available
-        UINT scanCode = MapVirtualKey(event.winKeyCode, MAPVK_VK_TO_VSC);
-        if (scanCode) {
-            input.ki.wScan = static_cast<WORD>(scanCode);
-            input.ki.dwFlags |= KEYEVENTF_SCANCODE; // Use scan code
-            // Don't use vk in this case
-            input.ki.wVk = 0;
-        }
-    }
+void PlaybackWorker::seekToEvent(size_t eventIndex) {
+    qDebug() << "PlaybackWorker requested to seek to event" << eventIndex;
+    m_engine.seekToEvent(eventIndex);
+}
 
-    UINT result = SendInput(1, &input, sizeof(INPUT));
-    if (result != 1) {
-        qDebug() << "PlaybackWorker (Win): SendInput failed with error code:" << GetLastError()
-                 << "for key:" << QString::fromStdString(event.key) << "state:" << QString::fromStdString(event.state);
-    }
-    // else {
-    //     qDebug() << "PlaybackWorker: Emulated (Win)" << QString::fromStdString(event.key) << event.state;
-    // }
-
-#else
-    qDebug() << "PlaybackWorker: Key emulation not supported on this platform.";
-#endif
-} 
\ No newline at end of file
+void PlaybackWorker::seekToTime(std::chrono::microseconds offset) {
+    m_engine.seekToTime(offset);
+}
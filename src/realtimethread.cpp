@@ -0,0 +1,231 @@
+#include "../include/realtimethread.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <pthread/qos.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace { // Use an anonymous namespace to limit scope
+
+// Smallest page size on the platforms we support; touching more often is harmless
+constexpr size_t kPageSize = 4096;
+// Stack the playback loop may reach, mapped before memory is locked
+constexpr size_t kStackPrefault = 64 * 1024;
+
+void prefaultStack() {
+    volatile unsigned char stack[kStackPrefault];
+    for (size_t i = 0; i < kStackPrefault; i += kPageSize) {
+        stack[i] = 0;
+    }
+    (void)stack[kStackPrefault - 1];
+}
+
+} // end anonymous namespace
+
+void RealtimeScope::warn(const std::string& message) {
+    if (!m_warnings.empty()) {
+        m_warnings += "; ";
+    }
+    m_warnings += message;
+}
+
+void RealtimeScope::prefault(const void* data, size_t bytes) {
+    const volatile unsigned char* bytesIn = static_cast<const volatile unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i += kPageSize) {
+        (void)bytesIn[i];
+    }
+    if (bytes > 0) {
+        (void)bytesIn[bytes - 1];
+    }
+}
+
+#ifdef _WIN32
+
+RealtimeScope::RealtimeScope(const RealtimeOptions& options) {
+    if (!options.enabled) {
+        return;
+    }
+    prefaultStack();
+
+    // Windows has no FIFO policy; TIME_CRITICAL is the top of the normal class
+    HANDLE thread = GetCurrentThread();
+    m_oldPriority = GetThreadPriority(thread);
+    if (SetThreadPriority(thread, THREAD_PRIORITY_TIME_CRITICAL)) {
+        m_realtime = true;
+        m_mode = "TIME_CRITICAL";
+    } else {
+        warn("SetThreadPriority failed (error " + std::to_string(GetLastError()) + ")");
+        m_mode = "normal";
+    }
+
+    if (options.cpu >= 0) {
+        const DWORD_PTR oldMask = options.cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)
+            ? SetThreadAffinityMask(thread, static_cast<DWORD_PTR>(1) << options.cpu)
+            : 0;
+        if (oldMask != 0) {
+            m_pinned = true;
+            m_mode += " cpu" + std::to_string(options.cpu);
+            for (int cpu = 0; cpu < static_cast<int>(sizeof(DWORD_PTR) * 8); ++cpu) {
+                if (oldMask & (static_cast<DWORD_PTR>(1) << cpu)) {
+                    m_oldCpus.push_back(cpu);
+                }
+            }
+        } else {
+            warn("cannot pin to CPU " + std::to_string(options.cpu));
+        }
+    }
+
+    if (options.lockMemory) {
+        warn("memory locking is not supported on Windows; buffers are prefaulted only");
+    }
+}
+
+RealtimeScope::~RealtimeScope() {
+    HANDLE thread = GetCurrentThread();
+    if (!m_oldCpus.empty()) {
+        DWORD_PTR mask = 0;
+        for (int cpu : m_oldCpus) {
+            mask |= static_cast<DWORD_PTR>(1) << cpu;
+        }
+        SetThreadAffinityMask(thread, mask);
+    }
+    if (m_realtime) {
+        SetThreadPriority(thread, m_oldPriority);
+    }
+}
+
+#elif defined(__APPLE__)
+
+RealtimeScope::RealtimeScope(const RealtimeOptions& options) {
+    if (!options.enabled) {
+        return;
+    }
+    prefaultStack();
+
+    // macOS exposes neither SCHED_FIFO to user processes nor CPU affinity; the
+    // user-interactive QoS class is the closest we get
+    qos_class_t oldClass = QOS_CLASS_DEFAULT;
+    int oldRelativePriority = 0;
+    pthread_get_qos_class_np(pthread_self(), &oldClass, &oldRelativePriority);
+    m_oldPolicy = static_cast<int>(oldClass);
+    m_oldPriority = oldRelativePriority;
+    if (pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0) {
+        m_realtime = true;
+        m_mode = "QOS_USER_INTERACTIVE";
+    } else {
+        warn("cannot raise the thread QoS class");
+    }
+
+    if (options.cpu >= 0) {
+        warn("CPU pinning is not supported on macOS");
+    }
+    if (options.lockMemory) {
+        warn("memory locking is not supported on macOS; buffers are prefaulted only");
+    }
+}
+
+RealtimeScope::~RealtimeScope() {
+    if (m_realtime) {
+        pthread_set_qos_class_self_np(static_cast<qos_class_t>(m_oldPolicy), m_oldPriority);
+    }
+}
+
+#else
+
+RealtimeScope::RealtimeScope(const RealtimeOptions& options) {
+    if (!options.enabled) {
+        return;
+    }
+    // Map the stack the loop will use before locking, so MCL_CURRENT covers it
+    prefaultStack();
+
+    const pthread_t self = pthread_self();
+    sched_param oldParam{};
+    pthread_getschedparam(self, &m_oldPolicy, &oldParam);
+    m_oldPriority = oldParam.sched_priority;
+
+    // SCHED_FIFO first; some hosts only allow SCHED_RR through their rtprio limits
+    const int policies[] = {SCHED_FIFO, SCHED_RR};
+    const char* policyNames[] = {"SCHED_FIFO", "SCHED_RR"};
+    int error = 0;
+    for (int i = 0; i < 2 && !m_realtime; ++i) {
+        sched_param param{};
+        const int requested = options.priority > 0 ? options.priority : RealtimeOptions::kDefaultPriority;
+        param.sched_priority = std::clamp(requested, sched_get_priority_min(policies[i]),
+                                          sched_get_priority_max(policies[i]));
+        error = pthread_setschedparam(self, policies[i], &param);
+        if (error == 0) {
+            m_realtime = true;
+            m_mode = std::string(policyNames[i]) + "/" + std::to_string(param.sched_priority);
+        }
+    }
+    if (!m_realtime) {
+        warn(std::string("real-time scheduling not permitted (") + std::strerror(error) + ")");
+    }
+
+    if (options.cpu >= 0) {
+        cpu_set_t oldSet;
+        CPU_ZERO(&oldSet);
+        cpu_set_t newSet;
+        CPU_ZERO(&newSet);
+        if (options.cpu < CPU_SETSIZE) {
+            CPU_SET(options.cpu, &newSet);
+        }
+        const bool haveOld = pthread_getaffinity_np(self, sizeof(oldSet), &oldSet) == 0;
+        error = options.cpu < CPU_SETSIZE ? pthread_setaffinity_np(self, sizeof(newSet), &newSet) : EINVAL;
+        if (error == 0) {
+            m_pinned = true;
+            m_mode += " cpu" + std::to_string(options.cpu);
+            for (int cpu = 0; haveOld && cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &oldSet)) {
+                    m_oldCpus.push_back(cpu);
+                }
+            }
+        } else {
+            warn("cannot pin to CPU " + std::to_string(options.cpu) + " (" + std::strerror(error) + ")");
+        }
+    }
+
+    if (options.lockMemory) {
+        // MCL_CURRENT only: the tape and sink buffers already exist, and locking future
+        // allocations would also pin whatever the GUI thread allocates meanwhile
+        if (mlockall(MCL_CURRENT) == 0) {
+            m_memoryLocked = true;
+            m_mode += " mlock";
+        } else {
+            warn(std::string("mlockall failed (") + std::strerror(errno) + ")");
+        }
+    }
+}
+
+RealtimeScope::~RealtimeScope() {
+    if (m_memoryLocked) {
+        munlockall();
+    }
+    const pthread_t self = pthread_self();
+    if (!m_oldCpus.empty()) {
+        cpu_set_t oldSet;
+        CPU_ZERO(&oldSet);
+        for (int cpu : m_oldCpus) {
+            CPU_SET(cpu, &oldSet);
+        }
+        pthread_setaffinity_np(self, sizeof(oldSet), &oldSet);
+    }
+    if (m_realtime) {
+        sched_param param{};
+        param.sched_priority = m_oldPriority;
+        pthread_setschedparam(self, m_oldPolicy, &param);
+    }
+}
+
+#endif
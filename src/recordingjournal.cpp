@@ -0,0 +1,248 @@
+#include "../include/recordingjournal.h"
+#include "../include/sequencebinary.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace { // Use an anonymous namespace to limit scope
+
+constexpr char kFileMagic[4] = {'C', 'R', 'J', 'L'};
+constexpr char kBlockMagic[4] = {'C', 'J', 'B', 'K'};
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 24;
+constexpr size_t kBlockHeaderSize = 16;
+constexpr size_t kEventSize = 8;
+
+void putLe(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t getLe(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+std::FILE* openFile(const std::filesystem::path& path, bool write) {
+#ifdef _WIN32
+    return _wfopen(path.c_str(), write ? L"wb" : L"rb");
+#else
+    return std::fopen(path.c_str(), write ? "wb" : "rb");
+#endif
+}
+
+// Pushes written data through the OS cache to the device
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#elif defined(__APPLE__)
+    // Plain fsync on macOS stops at the drive cache
+    const int fd = fileno(file);
+    return fcntl(fd, F_FULLFSYNC) == 0 || fsync(fd) == 0;
+#else
+    return fdatasync(fileno(file)) == 0;
+#endif
+}
+
+} // end anonymous namespace
+
+RecordingJournal::~RecordingJournal() {
+    close();
+}
+
+bool RecordingJournal::open(const std::filesystem::path& path, std::string* error) {
+    close();
+
+    std::error_code ignored;
+    std::filesystem::create_directories(path.parent_path(), ignored);
+    m_file = openFile(path, true);
+    if (!m_file) {
+        if (error) *error = std::strerror(errno);
+        return false;
+    }
+
+    uint8_t header[kHeaderSize] = {};
+    std::memcpy(header, kFileMagic, sizeof(kFileMagic));
+    putLe(header + 4, kVersion, 2);
+    putLe(header + 8, static_cast<uint32_t>(SequenceBinary::currentPlatform()), 4);
+    putLe(header + 16, static_cast<uint64_t>(std::time(nullptr)), 8);
+    if (std::fwrite(header, 1, sizeof(header), m_file) != sizeof(header) || !syncFile(m_file)) {
+        if (error) *error = std::strerror(errno);
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+
+    m_pending.clear();
+    m_pending.reserve(kBlockEvents);
+    m_stopping = false;
+    m_error.clear();
+    m_nextBlock = 0;
+    m_committedEvents = 0;
+    m_commits = 0;
+    m_failed = false;
+    m_writerThread = std::thread(&RecordingJournal::writerLoop, this);
+    return true;
+}
+
+void RecordingJournal::close() {
+    if (!m_file) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_writerThread.join();  // Commits the remainder on the way out
+
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void RecordingJournal::append(const KeyEvent* events, size_t count) {
+    bool blockFull;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.insert(m_pending.end(), events, events + count);
+        blockFull = m_pending.size() >= kBlockEvents;
+    }
+    // Otherwise the writer picks the events up on its next commit interval
+    if (blockFull) {
+        m_wake.notify_one();
+    }
+}
+
+std::string RecordingJournal::errorString() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+void RecordingJournal::writerLoop() {
+    std::vector<KeyEvent> batch;
+    batch.reserve(kBlockEvents);
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, kCommitInterval,
+                            [this] { return m_stopping || m_pending.size() >= kBlockEvents; });
+            // Swap rather than copy, so append() never waits for the disk
+            batch.swap(m_pending);
+            stopping = m_stopping;
+        }
+
+        if (!batch.empty() && !m_failed.load(std::memory_order_relaxed) && !commit(batch)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_error = std::strerror(errno);
+            m_failed = true;
+        }
+        batch.clear();
+
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+bool RecordingJournal::commit(std::vector<KeyEvent>& events) {
+    // Every pending event goes into one write and one sync, however many blocks it takes
+    const size_t blocks = (events.size() + kBlockEvents - 1) / kBlockEvents;
+    m_scratch.resize(blocks * kBlockHeaderSize + events.size() * kEventSize);
+
+    uint8_t* out = m_scratch.data();
+    for (size_t first = 0; first < events.size(); first += kBlockEvents) {
+        const size_t count = std::min(kBlockEvents, events.size() - first);
+        uint8_t* payload = out + kBlockHeaderSize;
+        for (size_t i = 0; i < count; ++i) {
+            const KeyEvent& event = events[first + i];
+            uint8_t* record = payload + i * kEventSize;
+            putLe(record, event.delayUs, 4);
+            putLe(record + 4, event.code, 2);
+            putLe(record + 6, event.isDown() ? 1 : 0, 2);
+        }
+        std::memcpy(out, kBlockMagic, sizeof(kBlockMagic));
+        putLe(out + 4, m_nextBlock++, 4);
+        putLe(out + 8, count, 4);
+        putLe(out + 12, SequenceBinary::crc32(payload, count * kEventSize), 4);
+        out = payload + count * kEventSize;
+    }
+
+    if (std::fwrite(m_scratch.data(), 1, m_scratch.size(), m_file) != m_scratch.size() || !syncFile(m_file)) {
+        return false;
+    }
+    m_committedEvents.fetch_add(events.size(), std::memory_order_relaxed);
+    m_commits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool RecordingJournal::recover(const std::filesystem::path& path, const KeyResolver& resolver, Recovered* out) {
+    std::FILE* file = openFile(path, false);
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> contents;
+    uint8_t chunk[64 * 1024];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        contents.insert(contents.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+
+    if (contents.size() < kHeaderSize || std::memcmp(contents.data(), kFileMagic, sizeof(kFileMagic)) != 0
+        || getLe(contents.data() + 4, 2) > kVersion) {
+        return false;
+    }
+    out->events.clear();
+    out->startedAtUnix = static_cast<int64_t>(getLe(contents.data() + 16, 8));
+    out->tornTail = false;
+
+    // Stop at the first block that is short, out of order or fails its checksum;
+    // everything before it was committed intact
+    const uint8_t* p = contents.data() + kHeaderSize;
+    const uint8_t* end = contents.data() + contents.size();
+    for (uint32_t block = 0; p < end; ++block) {
+        if (static_cast<size_t>(end - p) < kBlockHeaderSize || std::memcmp(p, kBlockMagic, sizeof(kBlockMagic)) != 0
+            || getLe(p + 4, 4) != block) {
+            out->tornTail = true;
+            break;
+        }
+        const size_t count = static_cast<size_t>(getLe(p + 8, 4));
+        const uint8_t* payload = p + kBlockHeaderSize;
+        if (count == 0 || count > kBlockEvents || static_cast<size_t>(end - payload) < count * kEventSize
+            || SequenceBinary::crc32(payload, count * kEventSize) != getLe(p + 12, 4)) {
+            out->tornTail = true;
+            break;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* record = payload + i * kEventSize;
+            const uint16_t code = static_cast<uint16_t>(getLe(record + 4, 2));
+            out->events.emplace_back(resolver(code), code, getLe(record + 6, 2) != 0,
+                                     static_cast<uint32_t>(getLe(record, 4)));
+        }
+        p = payload + count * kEventSize;
+    }
+    return !out->events.empty();
+}
+
+void RecordingJournal::discard(const std::filesystem::path& path) {
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+}
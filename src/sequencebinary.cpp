@@ -0,0 +1,270 @@
+#include "../include/sequencebinary.h"
+#include "../include/keytables.h"
+
+#include <array>
+#include <cstring>
+#include <map>
+#include <utility>
+
+namespace { // Use an anonymous namespace to limit scope
+
+// Table-driven CRC-32 (IEEE 802.3, as used by zip and PNG)
+constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+constexpr std::array<uint32_t, 256> kCrcTable = makeCrcTable();
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Returns false on truncation or a varint longer than 10 bytes
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t byte = *p++;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void putLe(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t getLe(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void fail(std::string* error, const char* message) {
+    if (error) *error = message;
+}
+
+// The smallest dictionary entry and event are two one-byte varints
+constexpr uint32_t kMinRecordBytes = 2;
+// Header bytes covered by the checksum: everything between the magic and the checksum
+constexpr size_t kChecksummedHeaderOffset = 4;
+constexpr size_t kChecksumOffset = 36;
+
+uint32_t imageChecksum(const uint8_t* image, size_t size, uint16_t version) {
+    uint32_t crc = 0;
+    if (version >= 2) {
+        crc = SequenceBinary::crc32(image + kChecksummedHeaderOffset, kChecksumOffset - kChecksummedHeaderOffset);
+    }
+    return SequenceBinary::crc32(image + SequenceBinary::kHeaderSize, size - SequenceBinary::kHeaderSize, crc);
+}
+
+} // end anonymous namespace
+
+namespace SequenceBinary {
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc) {
+    crc ^= 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = kCrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+Platform currentPlatform() {
+#ifdef _WIN32
+    return Platform::Windows;
+#elif defined(__APPLE__)
+    return Platform::MacOS;
+#elif defined(__linux__)
+    return Platform::Linux;
+#else
+    return Platform::Unknown;
+#endif
+}
+
+bool isBinary(const uint8_t* data, size_t size) {
+    return size >= sizeof(kMagic) && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+std::vector<uint8_t> encode(const std::vector<KeyEvent>& events) {
+    // Dictionary entries in order of first use, so early events get small indices
+    std::map<std::pair<uint16_t, uint16_t>, uint32_t> entryIndex;
+    std::vector<std::pair<uint16_t, uint16_t>> entries;
+    std::vector<uint8_t> eventBytes;
+    eventBytes.reserve(events.size() * 3);
+
+    uint64_t durationUs = 0;
+    int64_t previousEntry = 0;
+    for (const KeyEvent& event : events) {
+        const std::pair<uint16_t, uint16_t> key{event.keyId, static_cast<uint16_t>(event.code)};
+        auto it = entryIndex.find(key);
+        if (it == entryIndex.end()) {
+            it = entryIndex.emplace(key, static_cast<uint32_t>(entries.size())).first;
+            entries.push_back(key);
+        }
+        const int64_t entry = it->second;
+
+        putVarint(eventBytes, event.delayUs);
+        putVarint(eventBytes, (zigzag(entry - previousEntry) << 1) | (event.isDown() ? 1u : 0u));
+        previousEntry = entry;
+        durationUs += event.delayUs;
+    }
+
+    std::vector<uint8_t> dictionaryBytes;
+    for (const auto& [keyId, code] : entries) {
+        const std::string name = KeyNames::name(keyId);
+        putVarint(dictionaryBytes, code);
+        putVarint(dictionaryBytes, name.size());
+        dictionaryBytes.insert(dictionaryBytes.end(), name.begin(), name.end());
+    }
+
+    std::vector<uint8_t> out(kHeaderSize);
+    out.reserve(kHeaderSize + dictionaryBytes.size() + eventBytes.size());
+    out.insert(out.end(), dictionaryBytes.begin(), dictionaryBytes.end());
+    out.insert(out.end(), eventBytes.begin(), eventBytes.end());
+
+    uint8_t* h = out.data();
+    std::memcpy(h, kMagic, sizeof(kMagic));
+    putLe(h + 4, kVersion, 2);
+    putLe(h + 6, 0, 2);
+    putLe(h + 8, events.size(), 4);
+    putLe(h + 12, entries.size(), 4);
+    putLe(h + 16, dictionaryBytes.size(), 4);
+    putLe(h + 20, eventBytes.size(), 4);
+    putLe(h + 24, static_cast<uint32_t>(currentPlatform()), 4);
+    putLe(h + 28, durationUs, 8);
+    putLe(h + kChecksumOffset, imageChecksum(out.data(), out.size(), kVersion), 4);
+    return out;
+}
+
+bool Reader::open(const uint8_t* data, size_t size, std::string* error) {
+    m_entries.clear();
+    m_events = nullptr;
+    m_sections = nullptr;
+
+    if (size < kHeaderSize || !isBinary(data, size)) {
+        fail(error, "Not a Craftium binary sequence file.");
+        return false;
+    }
+
+    m_header.version = static_cast<uint16_t>(getLe(data + 4, 2));
+    m_header.flags = static_cast<uint16_t>(getLe(data + 6, 2));
+    m_header.eventCount = static_cast<uint32_t>(getLe(data + 8, 4));
+    m_header.dictionaryCount = static_cast<uint32_t>(getLe(data + 12, 4));
+    m_header.dictionaryBytes = static_cast<uint32_t>(getLe(data + 16, 4));
+    m_header.eventBytes = static_cast<uint32_t>(getLe(data + 20, 4));
+    m_header.platform = static_cast<Platform>(getLe(data + 24, 4));
+    m_header.durationUs = getLe(data + 28, 8);
+    m_header.checksum = static_cast<uint32_t>(getLe(data + 36, 4));
+
+    if (m_header.version > kVersion) {
+        fail(error, "Sequence file was written by a newer version of Craftium.");
+        return false;
+    }
+    if (static_cast<uint64_t>(m_header.dictionaryBytes) + m_header.eventBytes != size - kHeaderSize) {
+        fail(error, "Sequence file is truncated or has trailing data.");
+        return false;
+    }
+    // Counts size the allocations below, so they must fit in their sections whatever the checksum says
+    if (m_header.dictionaryCount > m_header.dictionaryBytes / kMinRecordBytes
+        || m_header.eventCount > m_header.eventBytes / kMinRecordBytes) {
+        fail(error, "Sequence file header is corrupt.");
+        return false;
+    }
+    if (imageChecksum(data, size, m_header.version) != m_header.checksum) {
+        fail(error, "Sequence file is corrupt (checksum mismatch).");
+        return false;
+    }
+
+    m_sections = data + kHeaderSize;
+    m_events = m_sections + m_header.dictionaryBytes;
+
+    // Codes only carry over when the file was written on this platform
+    const bool sameCodes = m_header.platform == currentPlatform();
+    const uint8_t* p = m_sections;
+    m_entries.reserve(m_header.dictionaryCount);
+    for (uint32_t i = 0; i < m_header.dictionaryCount; ++i) {
+        uint64_t code = 0;
+        uint64_t length = 0;
+        if (!getVarint(p, m_events, &code) || !getVarint(p, m_events, &length)
+            || length > static_cast<uint64_t>(m_events - p)) {
+            fail(error, "Sequence file dictionary is corrupt.");
+            return false;
+        }
+        const std::string name(reinterpret_cast<const char*>(p), static_cast<size_t>(length));
+        p += length;
+
+        Entry entry{KeyNames::intern(name), static_cast<uint16_t>(code & 0x7FFF)};
+        if (!sameCodes) {
+            const int resolved = KeyTables::codeForName(name);
+            entry.code = resolved >= 0 ? static_cast<uint16_t>(resolved) : 0;
+        }
+        m_entries.push_back(entry);
+    }
+    return true;
+}
+
+bool Reader::decode(std::vector<KeyEvent>* events, std::string* error, const Progress& progress) const {
+    if (!m_events) {
+        fail(error, "Sequence file is not open.");
+        return false;
+    }
+
+    const uint8_t* p = m_events;
+    const uint8_t* end = m_events + m_header.eventBytes;
+    const size_t start = events->size();
+    events->reserve(start + m_header.eventCount);
+
+    int64_t entry = 0;
+    for (uint32_t i = 0; i < m_header.eventCount; ++i) {
+        if (progress && i % kProgressStride == 0 && !progress(i, m_header.eventCount)) {
+            events->resize(start);
+            fail(error, "Cancelled.");
+            return false;
+        }
+        uint64_t delayUs = 0;
+        uint64_t packed = 0;
+        if (!getVarint(p, end, &delayUs) || !getVarint(p, end, &packed)) {
+            events->resize(start);
+            fail(error, "Sequence file events are truncated.");
+            return false;
+        }
+        entry += unzigzag(packed >> 1);
+        if (entry < 0 || static_cast<size_t>(entry) >= m_entries.size()) {
+            events->resize(start);
+            fail(error, "Sequence file references an unknown key.");
+            return false;
+        }
+        const Entry& e = m_entries[static_cast<size_t>(entry)];
+        events->emplace_back(e.keyId, e.code, (packed & 1) != 0, KeyEvent::clampDelayUs(static_cast<long long>(delayUs)));
+    }
+    return true;
+}
+
+} // namespace SequenceBinary
@@ -0,0 +1,147 @@
+#include "../include/sequencefile.h"
+#include "../include/keytables.h"
+#include "../include/sequencebinary.h"
+#include "../include/sequencejson.h"
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace { // Use an anonymous namespace to limit scope
+
+constexpr qint64 kWriteChunk = 1 << 20;
+
+// Adapts a percentage callback to the (done, total) form the codecs report in
+std::function<bool(size_t, size_t)> percentOf(const SequenceFile::Progress& progress) {
+    if (!progress) {
+        return nullptr;
+    }
+    return [&progress](size_t done, size_t total) {
+        return progress(total > 0 ? static_cast<int>(done * 100 / total) : 100);
+    };
+}
+
+bool loadJson(const uint8_t* data, size_t size, std::vector<KeyEvent>* events, QString* error,
+              const SequenceFile::Progress& progress) {
+    std::string message;
+    if (!SequenceJson::parse(reinterpret_cast<const char*>(data), size, SequenceFile::platformCodeField(),
+                             events, &message, percentOf(progress))) {
+        if (error) *error = QString::fromStdString(message);
+        return false;
+    }
+    return true;
+}
+
+bool loadBinary(const uint8_t* data, size_t size, std::vector<KeyEvent>* events, QString* error,
+                const SequenceFile::Progress& progress) {
+    SequenceBinary::Reader reader;
+    std::string message;
+    if (!reader.open(data, size, &message)) {
+        if (error) *error = QString::fromStdString(message);
+        return false;
+    }
+
+    std::vector<KeyEvent> loaded;
+    if (!reader.decode(&loaded, &message, percentOf(progress))) {
+        if (error) *error = QString::fromStdString(message);
+        return false;
+    }
+    *events = std::move(loaded);
+    return true;
+}
+
+// Writes in chunks so a large binary image can report progress and be cancelled
+bool writeChunked(QSaveFile& file, const std::vector<uint8_t>& bytes, const SequenceFile::Progress& progress) {
+    const qint64 total = static_cast<qint64>(bytes.size());
+    for (qint64 offset = 0; offset < total; offset += kWriteChunk) {
+        if (progress && !progress(static_cast<int>(offset * 100 / total))) {
+            return false;
+        }
+        const qint64 length = std::min(kWriteChunk, total - offset);
+        if (file.write(reinterpret_cast<const char*>(bytes.data()) + offset, length) != length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // end anonymous namespace
+
+namespace SequenceFile {
+
+const char* platformCodeField() {
+#ifdef _WIN32
+    return "winKeyCode";
+#elif defined(__APPLE__)
+    return "macKeyCode";
+#else
+    return "linuxKeyCode";
+#endif
+}
+
+Format formatForFileName(const QString& fileName) {
+    return fileName.endsWith(QString(".") + kBinarySuffix, Qt::CaseInsensitive) ? Format::Binary : Format::Json;
+}
+
+bool load(const QString& fileName, std::vector<KeyEvent>* events, QString* error, const Progress& progress) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Could not open file for reading: " + file.errorString();
+        return false;
+    }
+
+    // Map the file instead of copying it; fall back to reading for devices that cannot be mapped
+    const qint64 size = file.size();
+    const uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+    const QByteArray contents = mapped ? QByteArray() : file.readAll();
+    const auto* data = mapped ? mapped : reinterpret_cast<const uint8_t*>(contents.constData());
+    const size_t length = mapped ? static_cast<size_t>(size) : static_cast<size_t>(contents.size());
+
+    // The format is detected from the contents, so a renamed file still loads.
+    // Both readers work on the mapped bytes directly.
+    const bool loaded = SequenceBinary::isBinary(data, length) ? loadBinary(data, length, events, error, progress)
+                                                               : loadJson(data, length, events, error, progress);
+    file.close(); // Unmaps
+    return loaded;
+}
+
+bool save(const QString& fileName, const std::vector<KeyEvent>& events, QString* error, const Progress& progress) {
+    return save(fileName, events, formatForFileName(fileName), error, progress);
+}
+
+bool save(const QString& fileName, const std::vector<KeyEvent>& events, Format format, QString* error,
+          const Progress& progress) {
+    // Written to a temporary file and renamed over the target on commit()
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = "Could not open file for writing: " + file.errorString();
+        return false;
+    }
+
+    bool cancelled = false;
+    const Progress tracked = progress ? Progress([&progress, &cancelled](int percent) {
+        cancelled = !progress(percent);
+        return !cancelled;
+    }) : Progress();
+
+    bool written;
+    if (format == Format::Binary) {
+        written = writeChunked(file, SequenceBinary::encode(events), tracked);
+    } else {
+        // Streamed in fixed-size chunks; no document is built in memory
+        written = SequenceJson::write(events, platformCodeField(), [&file](const char* data, size_t size) {
+            return file.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+        }, percentOf(tracked));
+    }
+
+    if (cancelled) {
+        if (error) *error = SequenceJson::kCancelled;
+        return false; // The destructor discards the temporary file
+    }
+    if (!written || !file.commit()) {
+        if (error) *error = "Could not write file: " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace SequenceFile
@@ -0,0 +1,89 @@
+#include "../include/sequenceioworker.h"
+#include "../include/sequencefile.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <vector>
+
+SequenceIoWorker::SequenceIoWorker(KeySequence* target, QObject* parent)
+    : QObject(parent), m_target(target) {}
+
+void SequenceIoWorker::cancel(quint64 request) {
+    quint64 current = m_cancelledThrough.load();
+    while (current < request && !m_cancelledThrough.compare_exchange_weak(current, request)) {
+    }
+}
+
+bool SequenceIoWorker::report(quint64 request, int percent, int* lastPercent) {
+    if (percent != *lastPercent) {
+        *lastPercent = percent;
+        emit progress(request, percent);
+    }
+    return !isCancelled(request);
+}
+
+void SequenceIoWorker::loadFile(quint64 request, const QString& fileName) {
+    if (isCancelled(request)) {
+        emit loadFinished(request, fileName, 0, QString(), true, nullptr);
+        return;
+    }
+    qDebug() << "SequenceIoWorker loading" << fileName << "in thread:" << QThread::currentThread();
+
+    QElapsedTimer timer;
+    timer.start();
+    int lastPercent = -1;
+    std::vector<KeyEvent> loaded;
+    QString error;
+    const bool ok = SequenceFile::load(fileName, &loaded, &error, [this, request, &lastPercent](int percent) {
+        return report(request, percent, &lastPercent);
+    });
+
+    // Indexing millions of events takes long enough to stall a repaint, so it happens here
+    const TimelineIndexPtr timeline = std::make_shared<TimelineIndex>();
+    if (ok && !isCancelled(request)) {
+        timeline->build(loaded);
+    }
+
+    // Last chance to cancel; after this the new sequence is visible everywhere
+    if (!ok || isCancelled(request)) {
+        const bool cancelled = isCancelled(request);
+        if (!cancelled) {
+            qWarning() << "SequenceIoWorker: load of" << fileName << "failed:" << error;
+        }
+        emit loadFinished(request, fileName, 0, cancelled ? QString() : error, cancelled, nullptr);
+        return;
+    }
+
+    const quint64 eventCount = loaded.size();
+    m_target->assign(std::move(loaded)); // O(1) pointer swap under the store's mutex
+    qDebug() << "SequenceIoWorker loaded" << eventCount << "events in" << timer.elapsed() << "ms";
+    emit loadFinished(request, fileName, eventCount, QString(), false, timeline);
+}
+
+void SequenceIoWorker::saveFile(quint64 request, const QString& fileName, const SequenceSnapshot& snapshot) {
+    if (isCancelled(request)) {
+        emit saveFinished(request, fileName, QString(), true);
+        return;
+    }
+    qDebug() << "SequenceIoWorker saving" << snapshot->size() << "events to" << fileName;
+
+    QElapsedTimer timer;
+    timer.start();
+    int lastPercent = -1;
+    QString error;
+    const bool ok = SequenceFile::save(fileName, *snapshot, &error, [this, request, &lastPercent](int percent) {
+        return report(request, percent, &lastPercent);
+    });
+
+    if (!ok) {
+        // A cancelled save is discarded before the rename, so the old file survives
+        const bool cancelled = isCancelled(request);
+        if (!cancelled) {
+            qWarning() << "SequenceIoWorker: save to" << fileName << "failed:" << error;
+        }
+        emit saveFinished(request, fileName, cancelled ? QString() : error, cancelled);
+        return;
+    }
+    qDebug() << "SequenceIoWorker saved in" << timer.elapsed() << "ms";
+    emit saveFinished(request, fileName, QString(), false);
+}
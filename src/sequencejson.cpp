@@ -0,0 +1,591 @@
+#include "../include/sequencejson.h"
+#include "../include/keytables.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CRAFTIUM_JSON_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define CRAFTIUM_JSON_NEON 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace { // Use an anonymous namespace to limit scope
+
+constexpr size_t kBlockSize = 64;
+constexpr size_t kWriteBufferSize = 64 * 1024;
+
+unsigned trailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+// Bit i set if an odd number of bits at or below i are set: marks string interiors
+// (opening quote included, closing quote excluded) from the unescaped quote positions
+uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+struct BlockMasks {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t structural = 0;  // { } [ ] : ,
+};
+
+// Classifies one 64-byte block. '[' and ']' differ from '{' and '}' only in bit 0x20,
+// so OR-ing it in lets two compares cover all four brackets.
+#if CRAFTIUM_JSON_SSE2
+BlockMasks classifyBlock(const uint8_t* p) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i openBrace = _mm_set1_epi8('{');
+    const __m128i closeBrace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+
+    BlockMasks masks;
+    for (int i = 0; i < 4; ++i) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        const __m128i folded = _mm_or_si128(v, caseBit);
+        const __m128i structural = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, openBrace), _mm_cmpeq_epi8(folded, closeBrace)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+        const int shift = 16 * i;
+        masks.quote |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << shift;
+        masks.backslash |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << shift;
+        masks.structural |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(structural))) << shift;
+    }
+    return masks;
+}
+#elif CRAFTIUM_JSON_NEON
+// NEON has no movemask: weight each lane by its bit and add pairwise down to 64 bits
+uint64_t movemask64(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d) {
+    static const uint8_t kWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t weights = vld1q_u8(kWeights);
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(a, weights), vandq_u8(b, weights));
+    const uint8x16_t sum1 = vpaddq_u8(vandq_u8(c, weights), vandq_u8(d, weights));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+BlockMasks classifyBlock(const uint8_t* p) {
+    uint8x16_t quote[4];
+    uint8x16_t backslash[4];
+    uint8x16_t structural[4];
+    for (int i = 0; i < 4; ++i) {
+        const uint8x16_t v = vld1q_u8(p + 16 * i);
+        const uint8x16_t folded = vorrq_u8(v, vdupq_n_u8(0x20));
+        quote[i] = vceqq_u8(v, vdupq_n_u8('"'));
+        backslash[i] = vceqq_u8(v, vdupq_n_u8('\\'));
+        structural[i] = vorrq_u8(vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}'))),
+                                 vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')), vceqq_u8(v, vdupq_n_u8(','))));
+    }
+    BlockMasks masks;
+    masks.quote = movemask64(quote[0], quote[1], quote[2], quote[3]);
+    masks.backslash = movemask64(backslash[0], backslash[1], backslash[2], backslash[3]);
+    masks.structural = movemask64(structural[0], structural[1], structural[2], structural[3]);
+    return masks;
+}
+#else
+BlockMasks classifyBlock(const uint8_t* p) {
+    BlockMasks masks;
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        const uint8_t c = p[i];
+        const uint64_t bit = uint64_t(1) << i;
+        if (c == '"') masks.quote |= bit;
+        if (c == '\\') masks.backslash |= bit;
+        const uint8_t folded = c | 0x20;
+        if (folded == '{' || folded == '}' || c == ':' || c == ',') masks.structural |= bit;
+    }
+    return masks;
+}
+#endif
+
+// Yields, in order, the position of every unescaped quote and every structural
+// character outside a string. Keeps one block of state, however large the input.
+class StructuralScanner {
+public:
+    StructuralScanner(const char* data, size_t size)
+        : m_data(reinterpret_cast<const uint8_t*>(data)), m_size(size) {}
+
+    bool next(size_t* pos) {
+        if (m_hasPending) {
+            m_hasPending = false;
+            *pos = m_pending;
+            return true;
+        }
+        while (m_mask == 0) {
+            if (m_nextBlock >= m_size) {
+                return false;
+            }
+            loadBlock();
+        }
+        *pos = m_blockStart + trailingZeros(m_mask);
+        m_mask &= m_mask - 1;
+        return true;
+    }
+
+    // Returns a position to the scanner; the next call to next() yields it again
+    void pushBack(size_t pos) {
+        m_hasPending = true;
+        m_pending = pos;
+    }
+
+private:
+    void loadBlock() {
+        const uint8_t* p = m_data + m_nextBlock;
+        uint8_t padded[kBlockSize];
+        const size_t available = m_size - m_nextBlock;
+        if (available < kBlockSize) {
+            std::memset(padded, ' ', kBlockSize);
+            std::memcpy(padded, p, available);
+            p = padded;
+        }
+        const BlockMasks masks = classifyBlock(p);
+
+        // Backslashes are rare, so resolving runs of them bit by bit stays cheap
+        uint64_t escaped = 0;
+        uint64_t backslashes = masks.backslash;
+        if (m_escapeCarry) {
+            escaped |= 1;
+            backslashes &= ~uint64_t(1);
+            m_escapeCarry = false;
+        }
+        while (backslashes) {
+            const unsigned i = trailingZeros(backslashes);
+            backslashes &= backslashes - 1;
+            if (i == kBlockSize - 1) {
+                m_escapeCarry = true;
+            } else {
+                escaped |= uint64_t(1) << (i + 1);
+                backslashes &= ~(uint64_t(1) << (i + 1));
+            }
+        }
+
+        const uint64_t quotes = masks.quote & ~escaped;
+        uint64_t inString = prefixXor(quotes);
+        if (m_inString) {
+            inString = ~inString;
+        }
+        m_inString = (inString >> 63) != 0;
+
+        m_mask = (masks.structural & ~inString) | quotes;
+        m_blockStart = m_nextBlock;
+        m_nextBlock += kBlockSize;
+    }
+
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_blockStart = 0;
+    size_t m_nextBlock = 0;
+    uint64_t m_mask = 0;
+    bool m_inString = false;
+    bool m_escapeCarry = false;
+    bool m_hasPending = false;
+    size_t m_pending = 0;
+};
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+bool parseHex4(std::string_view text, size_t at, uint32_t* value) {
+    if (at + 4 > text.size()) {
+        return false;
+    }
+    const auto result = std::from_chars(text.data() + at, text.data() + at + 4, *value, 16);
+    return result.ec == std::errc() && result.ptr == text.data() + at + 4;
+}
+
+// Decodes JSON string escapes; only called for the rare names that contain a backslash
+std::string unescape(std::string_view raw) {
+    std::string out;
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\' || i + 1 >= raw.size()) {
+            out += raw[i];
+            continue;
+        }
+        const char c = raw[++i];
+        switch (c) {
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            uint32_t codePoint = 0;
+            if (!parseHex4(raw, i + 1, &codePoint)) {
+                break;
+            }
+            i += 4;
+            uint32_t low = 0;
+            if (codePoint >= 0xD800 && codePoint < 0xDC00 && i + 2 < raw.size() && raw[i + 1] == '\\'
+                && raw[i + 2] == 'u' && parseHex4(raw, i + 3, &low) && low >= 0xDC00 && low < 0xE000) {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                i += 6;
+            }
+            appendUtf8(out, codePoint);
+            break;
+        }
+        default: out += c; break;  // \" \\ \/
+        }
+    }
+    return out;
+}
+
+std::string_view trim(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\n' || *begin == '\r')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) --end;
+    return std::string_view(begin, static_cast<size_t>(end - begin));
+}
+
+// Integer value of a JSON number; fractions are truncated, anything else reads as 0
+long long toInteger(std::string_view text) {
+    long long value = 0;
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec == std::errc() && result.ptr == text.data() + text.size()) {
+        return value;
+    }
+    char buffer[64];
+    if (text.empty() || text.size() >= sizeof(buffer)) {
+        return 0;
+    }
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+    char* end = nullptr;
+    const double number = std::strtod(buffer, &end);
+    return end == buffer + text.size() ? static_cast<long long>(number) : 0;
+}
+
+class Parser {
+public:
+    Parser(const char* data, size_t size, const char* codeField, const SequenceJson::Progress& progress)
+        : m_data(data), m_size(size), m_scanner(data, size), m_codeField(codeField), m_progress(progress) {}
+
+    bool cancelled() const { return m_cancelled; }
+
+    bool parse(std::vector<KeyEvent>* events) {
+        size_t pos = 0;
+        if (!m_scanner.next(&pos) || m_data[pos] != '[') {
+            return false;
+        }
+        for (;;) {
+            if (!m_scanner.next(&pos)) {
+                return false;
+            }
+            switch (m_data[pos]) {
+            case ']':
+                return true;
+            case ',':
+                break;
+            case '{':
+                if (!parseObject(events)) return false;
+                if (m_progress && events->size() % SequenceJson::kProgressStride == 0
+                    && !m_progress(pos, m_size)) {
+                    m_cancelled = true;
+                    return false;
+                }
+                break;
+            case '[':
+                if (!skipNested()) return false;
+                break;
+            case '"':
+                // A bare string element; skipped like any other non-object
+                if (!m_scanner.next(&pos) || m_data[pos] != '"') return false;
+                break;
+            default:
+                return false;
+            }
+        }
+    }
+
+private:
+    struct NameInfo {
+        uint16_t keyId;
+        int code;  // From the key table, for files recorded on another platform
+    };
+
+    // Called just after an opening '{' or '['
+    bool skipNested() {
+        int depth = 1;
+        size_t pos = 0;
+        while (depth > 0) {
+            if (!m_scanner.next(&pos)) {
+                return false;
+            }
+            const char c = m_data[pos];
+            if (c == '{' || c == '[') ++depth;
+            else if (c == '}' || c == ']') --depth;
+        }
+        return true;
+    }
+
+    const NameInfo& nameInfo(std::string_view raw) {
+        if (const auto it = m_names.find(raw); it != m_names.end()) {
+            return it->second;
+        }
+        const std::string name = raw.find('\\') == std::string_view::npos ? std::string(raw) : unescape(raw);
+        const NameInfo info{KeyNames::intern(name), KeyTables::codeForName(name)};
+        return m_names.emplace(raw, info).first->second;
+    }
+
+    bool parseObject(std::vector<KeyEvent>* events) {
+        std::string_view keyName;
+        bool down = false;
+        long long delayMs = 0;
+        long long delayUs = 0;
+        bool hasDelayUs = false;
+        long long code = 0;
+        bool hasCode = false;
+
+        size_t pos = 0;
+        for (;;) {
+            if (!m_scanner.next(&pos)) {
+                return false;
+            }
+            const char c = m_data[pos];
+            if (c == '}') {
+                break;
+            }
+            if (c == ',') {
+                continue;
+            }
+
+            size_t nameEnd = 0;
+            size_t colon = 0;
+            size_t value = 0;
+            if (c != '"' || !m_scanner.next(&nameEnd) || m_data[nameEnd] != '"'
+                || !m_scanner.next(&colon) || m_data[colon] != ':' || !m_scanner.next(&value)) {
+                return false;
+            }
+            const std::string_view field(m_data + pos + 1, nameEnd - pos - 1);
+
+            const char v = m_data[value];
+            if (v == '"') {
+                size_t valueEnd = 0;
+                if (!m_scanner.next(&valueEnd) || m_data[valueEnd] != '"') {
+                    return false;
+                }
+                const std::string_view text(m_data + value + 1, valueEnd - value - 1);
+                if (field == "key") {
+                    keyName = text;
+                } else if (field == "state") {
+                    down = text == "down";
+                }
+            } else if (v == '{' || v == '[') {
+                if (!skipNested()) return false;
+            } else if (v == ',' || v == '}') {
+                // Numbers and literals contain no structural characters: the value is
+                // everything between the colon and the terminator
+                const std::string_view text = trim(m_data + colon + 1, m_data + value);
+                if (field == "delayUs") {
+                    delayUs = toInteger(text);
+                    hasDelayUs = true;
+                } else if (field == "delay") {
+                    delayMs = toInteger(text);
+                } else if (field == m_codeField) {
+                    code = toInteger(text);
+                    hasCode = true;
+                }
+                m_scanner.pushBack(value);
+            } else {
+                return false;
+            }
+        }
+
+        // Same rules as the original loader: microseconds win over milliseconds, and a
+        // missing platform code is resolved from the key name
+        const NameInfo& info = nameInfo(keyName);
+        KeyEvent event(info.keyId, 0, down, KeyEvent::clampDelayUs(hasDelayUs ? delayUs : delayMs * 1000));
+        if (hasCode) {
+            event.code = static_cast<uint16_t>(code);
+        } else if (info.code >= 0) {
+            event.code = static_cast<uint16_t>(info.code);
+        }
+        events->push_back(event);
+        return true;
+    }
+
+    const char* m_data;
+    size_t m_size;
+    StructuralScanner m_scanner;
+    std::string_view m_codeField;
+    const SequenceJson::Progress& m_progress;
+    bool m_cancelled = false;
+    // Views into the input, which outlives the parser
+    std::unordered_map<std::string_view, NameInfo> m_names;
+};
+
+// Fixed-size staging buffer in front of the Output callback
+class OutputBuffer {
+public:
+    explicit OutputBuffer(const SequenceJson::Output& output) : m_output(output) {
+        m_buffer.resize(kWriteBufferSize);
+    }
+
+    void append(std::string_view text) {
+        if (m_used + text.size() > m_buffer.size()) {
+            flush();
+        }
+        if (text.size() > m_buffer.size()) {
+            m_ok = m_ok && m_output(text.data(), text.size());
+            return;
+        }
+        std::memcpy(m_buffer.data() + m_used, text.data(), text.size());
+        m_used += text.size();
+    }
+
+    void appendInteger(long long value) {
+        char digits[24];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        append(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+    bool flush() {
+        if (m_used > 0) {
+            m_ok = m_ok && m_output(m_buffer.data(), m_used);
+            m_used = 0;
+        }
+        return m_ok;
+    }
+
+private:
+    const SequenceJson::Output& m_output;
+    std::vector<char> m_buffer;
+    size_t m_used = 0;
+    bool m_ok = true;
+};
+
+// Quoted and escaped like QJsonDocument: short escapes where JSON has them, \u00XX for
+// other control characters, UTF-8 passed through
+std::string quote(const std::string& text) {
+    std::string out = "\"";
+    for (const char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+} // end anonymous namespace
+
+namespace SequenceJson {
+
+bool parse(const char* data, size_t size, const char* codeField,
+           std::vector<KeyEvent>* events, std::string* error, const Progress& progress) {
+    // Build the new sequence off to the side so a failed load leaves events untouched
+    std::vector<KeyEvent> loaded;
+    loaded.reserve(size / 96);  // Roughly one indented object per 100 bytes
+    Parser parser(data, size, codeField, progress);
+    if (!parser.parse(&loaded)) {
+        if (error) *error = parser.cancelled() ? kCancelled : "Invalid sequence file format.";
+        return false;
+    }
+    loaded.shrink_to_fit();
+    *events = std::move(loaded);
+    return true;
+}
+
+bool write(const std::vector<KeyEvent>& events, const char* codeField, const Output& output,
+           const Progress& progress) {
+    enum Field { Delay, DelayUs, Key, Code, State };
+    // QJsonDocument sorts object keys; the platform code field lands in a different
+    // place on each platform ("linuxKeyCode" < "state" < "winKeyCode")
+    Field order[] = {Delay, DelayUs, Key, Code, State};
+    const char* names[] = {"delay", "delayUs", "key", codeField, "state"};
+    std::sort(std::begin(order), std::end(order),
+              [&names](Field a, Field b) { return std::strcmp(names[a], names[b]) < 0; });
+
+    std::string fieldPrefix[5];
+    for (int f = 0; f < 5; ++f) {
+        fieldPrefix[f] = std::string("        \"") + names[f] + "\": ";
+    }
+
+    std::unordered_map<uint16_t, std::string> quotedNames;
+    OutputBuffer out(output);
+    out.append("[\n");
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (progress && i % kProgressStride == 0 && !progress(i, events.size())) {
+            return false;
+        }
+        const KeyEvent& event = events[i];
+        auto nameIt = quotedNames.find(event.keyId);
+        if (nameIt == quotedNames.end()) {
+            // Key names are only resolved here, at serialization time
+            nameIt = quotedNames.emplace(event.keyId, quote(KeyNames::name(event.keyId))).first;
+        }
+
+        out.append("    {\n");
+        for (int f = 0; f < 5; ++f) {
+            out.append(fieldPrefix[order[f]]);
+            switch (order[f]) {
+            case Delay: out.appendInteger(event.delayUs / 1000); break;  // Kept for older readers
+            case DelayUs: out.appendInteger(event.delayUs); break;
+            case Key: out.append(nameIt->second); break;
+            case Code: out.appendInteger(event.code); break;
+            case State: out.append(event.isDown() ? "\"down\"" : "\"up\""); break;
+            }
+            out.append(f < 4 ? ",\n" : "\n");
+        }
+        out.append(i + 1 < events.size() ? "    },\n" : "    }\n");
+    }
+    out.append("]\n");
+    return out.flush();
+}
+
+} // namespace SequenceJson
@@ -0,0 +1,58 @@
+#include "../include/sequencelistmodel.h"
+
+SequenceListModel::SequenceListModel(QObject* parent)
+    : QAbstractListModel(parent) {}
+
+int SequenceListModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_events.size());
+}
+
+QVariant SequenceListModel::data(const QModelIndex& index, int role) const {
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    // Formatted on demand, only for rows the view is about to paint
+    const size_t row = static_cast<size_t>(index.row());
+    const KeyEvent& event = m_events[row];
+    const QString delayMs = QString::number(event.delayUs / 1000.0, 'f', 3);
+    if (row == 0) {
+        return QString("Wait %1ms").arg(delayMs);
+    }
+    return QString("Key %1 %2 (wait %3ms)")
+        .arg(QString::fromStdString(KeyNames::name(event.keyId)))
+        .arg(QLatin1String(KeyEvent::stateName(event.isDown())))
+        .arg(delayMs);
+}
+
+void SequenceListModel::sync(const KeySequence& sequence) {
+    std::vector<KeyEvent> tail;
+    const uint64_t epoch = sequence.copyTail(m_events.size(), &tail);
+
+    if (epoch != m_epoch) {
+        // Cleared or replaced since the last sync: start over from the first event
+        tail.clear();
+        m_epoch = sequence.copyTail(0, &tail);
+        beginResetModel();
+        m_events = std::move(tail);
+        m_totalTimeUs = 0;
+        for (const KeyEvent& event : m_events) {
+            m_totalTimeUs += event.delayUs;
+        }
+        endResetModel();
+        emit totalsChanged();
+        return;
+    }
+
+    if (tail.empty()) {
+        return;
+    }
+    const int first = static_cast<int>(m_events.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(tail.size()) - 1);
+    for (const KeyEvent& event : tail) {
+        m_totalTimeUs += event.delayUs;
+    }
+    m_events.insert(m_events.end(), tail.begin(), tail.end());
+    endInsertRows();
+    emit totalsChanged();
+}
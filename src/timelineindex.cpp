@@ -0,0 +1,255 @@
+#include "../include/timelineindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace { // Use an anonymous namespace to limit scope
+
+// Lanes with fewer intervals than this are always drawn from the raw intervals, which
+// is already cheap; most keys in a recording stay below it and need no pyramid
+constexpr size_t kPyramidThreshold = 1024;
+
+// Adds one down/up interval to the columns it overlaps, and its press to the column it starts in
+void addInterval(int64_t downUs, int64_t upUs, double startUs, double usPerColumn,
+                 std::vector<TimelineIndex::Column>* out) {
+    const double endUs = startUs + static_cast<double>(out->size()) * usPerColumn;
+    if (static_cast<double>(downUs) >= endUs || static_cast<double>(upUs) < startUs) {
+        return;
+    }
+    const double lastColumn = static_cast<double>(out->size() - 1);
+    const double down = std::max(static_cast<double>(downUs), startUs);
+    const double up = std::min(static_cast<double>(upUs), endUs);
+
+    // Rounding near endUs can put a time inside the view one column past the last
+    const size_t first = static_cast<size_t>(std::min(lastColumn, (down - startUs) / usPerColumn));
+    const size_t last = static_cast<size_t>(std::min(lastColumn, (up - startUs) / usPerColumn));
+    if (static_cast<double>(downUs) >= startUs) {
+        (*out)[first].presses++;
+    }
+    for (size_t c = first; c <= last; ++c) {
+        const double columnStart = startUs + static_cast<double>(c) * usPerColumn;
+        const double overlap = std::min(up, columnStart + usPerColumn) - std::max(down, columnStart);
+        if (overlap > 0.0) {
+            TimelineIndex::Column& column = (*out)[c];
+            column.coverage = std::min(1.0f, column.coverage + static_cast<float>(overlap / usPerColumn));
+        }
+    }
+}
+
+} // end anonymous namespace
+
+void TimelineIndex::clear() {
+    m_eventTimesUs.clear();
+    m_lanes.clear();
+    m_laneOfKey.clear();
+    m_durationUs = 0;
+    m_bucketUs = 1;
+}
+
+void TimelineIndex::build(const std::vector<KeyEvent>& events) {
+    clear();
+    append(events.data(), events.size());
+}
+
+void TimelineIndex::append(const KeyEvent* events, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (m_laneOfKey.empty()) {
+        m_laneOfKey.assign(UINT16_MAX + 1, -1);
+    }
+
+    int64_t timeUs = m_eventTimesUs.empty() ? 0 : m_eventTimesUs.back();
+    for (const KeyEvent* event = events; event != events + count; ++event) {
+        timeUs += event->delayUs;
+        m_eventTimesUs.push_back(timeUs);
+
+        int32_t& laneIndex = m_laneOfKey[event->keyId];
+        if (laneIndex < 0) {
+            laneIndex = static_cast<int32_t>(m_lanes.size());
+            m_lanes.emplace_back();
+            m_lanes.back().keyId = event->keyId;
+        }
+        Lane& lane = m_lanes[laneIndex];
+
+        // Auto-repeat downs while the key is held extend the same interval
+        if (event->isDown()) {
+            if (lane.heldSinceUs < 0) {
+                lane.heldSinceUs = timeUs;
+            }
+        } else if (lane.heldSinceUs >= 0) {
+            lane.intervals.push_back({lane.heldSinceUs, timeUs});
+            lane.heldSinceUs = -1;
+        }
+    }
+    m_durationUs = std::max<int64_t>(timeUs, 1);
+
+    // Keep level 0 within kBaseBuckets: doubling the bucket width turns level 1 into level 0
+    while (m_durationUs / m_bucketUs >= static_cast<int64_t>(kBaseBuckets)) {
+        m_bucketUs *= 2;
+        for (Lane& lane : m_lanes) {
+            if (lane.levels.size() > 1) {
+                lane.levels.erase(lane.levels.begin());
+            } else if (!lane.levels.empty()) {
+                lane.levels.front() = coarsen(lane.levels.front());
+            }
+        }
+    }
+
+    for (Lane& lane : m_lanes) {
+        if (!lane.levels.empty()) {
+            extendPyramid(lane);
+        } else if (lane.intervals.size() >= kPyramidThreshold) {
+            buildPyramid(lane);
+        }
+    }
+}
+
+void TimelineIndex::buildPyramid(Lane& lane) const {
+    const size_t baseCount = static_cast<size_t>(m_durationUs / m_bucketUs) + 1;
+    std::vector<Bucket> base(baseCount);
+
+    // Intervals do not overlap, so filling level 0 is O(intervals + buckets)
+    for (const Interval& interval : lane.intervals) {
+        addToBuckets(interval, m_bucketUs, &base);
+    }
+
+    lane.levels.clear();
+    lane.levels.push_back(std::move(base));
+    while (lane.levels.back().size() > 1) {
+        lane.levels.push_back(coarsen(lane.levels.back()));
+    }
+    lane.pyramidIntervals = lane.intervals.size();
+}
+
+void TimelineIndex::extendPyramid(Lane& lane) const {
+    for (size_t level = 0; level < lane.levels.size(); ++level) {
+        const int64_t bucketUs = m_bucketUs << level;
+        lane.levels[level].resize(std::max(lane.levels[level].size(),
+                                           static_cast<size_t>(m_durationUs / bucketUs) + 1));
+    }
+    while (lane.levels.back().size() > 1) {
+        lane.levels.push_back(coarsen(lane.levels.back()));
+    }
+
+    if (lane.pyramidIntervals == lane.intervals.size()) {
+        return;
+    }
+
+    // New intervals go into level 0; only the buckets above the ones they touched are
+    // summed again, so this is O(new intervals + touched buckets)
+    size_t first = SIZE_MAX;
+    size_t last = 0;
+    for (size_t i = lane.pyramidIntervals; i < lane.intervals.size(); ++i) {
+        const Interval& interval = lane.intervals[i];
+        addToBuckets(interval, m_bucketUs, &lane.levels[0]);
+        first = std::min(first, static_cast<size_t>(interval.downUs / m_bucketUs));
+        last = std::max(last, static_cast<size_t>(std::max(interval.downUs, interval.upUs - 1) / m_bucketUs));
+    }
+    for (size_t level = 1; level < lane.levels.size(); ++level) {
+        const std::vector<Bucket>& finer = lane.levels[level - 1];
+        std::vector<Bucket>& buckets = lane.levels[level];
+        first /= 2;
+        last = std::min(last / 2, buckets.size() - 1);
+        for (size_t b = first; b <= last; ++b) {
+            buckets[b] = finer[2 * b];
+            if (2 * b + 1 < finer.size()) {
+                buckets[b].presses += finer[2 * b + 1].presses;
+                buckets[b].heldUs += finer[2 * b + 1].heldUs;
+            }
+        }
+    }
+    lane.pyramidIntervals = lane.intervals.size();
+}
+
+void TimelineIndex::addToBuckets(const Interval& interval, int64_t bucketUs, std::vector<Bucket>* buckets) {
+    const size_t first = static_cast<size_t>(interval.downUs / bucketUs);
+    (*buckets)[first].presses++;
+    const size_t last = static_cast<size_t>(std::max(interval.downUs, interval.upUs - 1) / bucketUs);
+    for (size_t b = first; b <= last && b < buckets->size(); ++b) {
+        const int64_t bucketStart = static_cast<int64_t>(b) * bucketUs;
+        const int64_t overlap = std::min(interval.upUs, bucketStart + bucketUs) - std::max(interval.downUs, bucketStart);
+        if (overlap > 0) {
+            (*buckets)[b].heldUs += static_cast<uint64_t>(overlap);
+        }
+    }
+}
+
+std::vector<TimelineIndex::Bucket> TimelineIndex::coarsen(const std::vector<Bucket>& finer) {
+    std::vector<Bucket> coarser((finer.size() + 1) / 2);
+    for (size_t i = 0; i < finer.size(); ++i) {
+        coarser[i / 2].presses += finer[i].presses;
+        coarser[i / 2].heldUs += finer[i].heldUs;
+    }
+    return coarser;
+}
+
+int64_t TimelineIndex::eventTimeUs(size_t eventIndex) const {
+    if (eventIndex >= m_eventTimesUs.size()) {
+        return m_durationUs;
+    }
+    return m_eventTimesUs[eventIndex];
+}
+
+size_t TimelineIndex::eventAtTime(int64_t timeUs) const {
+    return static_cast<size_t>(std::lower_bound(m_eventTimesUs.begin(), m_eventTimesUs.end(), timeUs)
+                               - m_eventTimesUs.begin());
+}
+
+void TimelineIndex::sample(size_t lane, double startUs, double usPerColumn, size_t columnCount,
+                           std::vector<Column>* out) const {
+    out->assign(columnCount, Column{});
+    if (lane >= m_lanes.size() || columnCount == 0 || usPerColumn <= 0.0) {
+        return;
+    }
+    const Lane& data = m_lanes[lane];
+    if (data.levels.empty() || usPerColumn < static_cast<double>(m_bucketUs)) {
+        sampleIntervals(data, startUs, usPerColumn, columnCount, out);
+        return;
+    }
+
+    // Coarsest level whose buckets still fit inside a column: one or two buckets each
+    const size_t level = std::min(data.levels.size() - 1,
+                                  static_cast<size_t>(std::log2(usPerColumn / static_cast<double>(m_bucketUs))));
+    const std::vector<Bucket>& buckets = data.levels[level];
+    const double bucketUs = static_cast<double>(m_bucketUs) * static_cast<double>(1ULL << level);
+    const double count = static_cast<double>(buckets.size());
+
+    for (size_t i = 0; i < columnCount; ++i) {
+        // A column owns the buckets that start inside it, so nothing is counted twice
+        const double columnStart = startUs + static_cast<double>(i) * usPerColumn;
+        const double first = std::clamp(std::ceil(columnStart / bucketUs), 0.0, count);
+        const double last = std::clamp(std::ceil((columnStart + usPerColumn) / bucketUs), 0.0, count);
+        uint64_t heldUs = 0;
+        uint32_t presses = 0;
+        for (size_t b = static_cast<size_t>(first); b < static_cast<size_t>(last); ++b) {
+            heldUs += buckets[b].heldUs;
+            presses += buckets[b].presses;
+        }
+        if (last > first) {
+            Column& column = (*out)[i];
+            column.coverage = static_cast<float>(std::min(1.0, static_cast<double>(heldUs) / ((last - first) * bucketUs)));
+            column.presses = presses;
+        }
+    }
+    if (data.heldSinceUs >= 0) {
+        addInterval(data.heldSinceUs, m_durationUs, startUs, usPerColumn, out);
+    }
+}
+
+void TimelineIndex::sampleIntervals(const Lane& lane, double startUs, double usPerColumn, size_t columnCount,
+                                    std::vector<Column>* out) const {
+    const double endUs = startUs + static_cast<double>(columnCount) * usPerColumn;
+
+    // Interval ends are sorted too, so the first visible one is a binary search away
+    auto it = std::upper_bound(lane.intervals.begin(), lane.intervals.end(), startUs,
+                               [](double time, const Interval& interval) { return time < interval.upUs; });
+    for (; it != lane.intervals.end() && static_cast<double>(it->downUs) < endUs; ++it) {
+        addInterval(it->downUs, it->upUs, startUs, usPerColumn, out);
+    }
+    // A key still down at the end is drawn held to the end
+    if (lane.heldSinceUs >= 0) {
+        addInterval(lane.heldSinceUs, m_durationUs, startUs, usPerColumn, out);
+    }
+}
@@ -0,0 +1,298 @@
+#include "../include/timelinewidget.h"
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+namespace { // Use an anonymous namespace to limit scope
+
+constexpr int kAlphaLevels = 8;         // Coverage is drawn in this many shades so runs can merge
+constexpr double kWheelZoomBase = 1.0015;  // Per 1/8 degree of wheel rotation
+constexpr int kMinTickSpacing = 80;     // Pixels between axis labels
+
+QString formatTime(double us, double stepUs) {
+    if (stepUs >= 1e6) {
+        return QString::number(us / 1e6, 'f', stepUs >= 1e7 ? 0 : 1) + "s";
+    }
+    if (stepUs >= 1e3) {
+        return QString::number(us / 1e3, 'f', stepUs >= 1e4 ? 0 : 1) + "ms";
+    }
+    return QString::number(us, 'f', 0) + "us";
+}
+
+} // end anonymous namespace
+
+TimelineWidget::TimelineWidget(QWidget* parent)
+    : QWidget(parent) {
+    setMinimumHeight(kAxisHeight + 24);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    setToolTip("Wheel to zoom, drag or Shift+wheel to pan, double-click to fit, click to seek during playback");
+}
+
+QSize TimelineWidget::sizeHint() const {
+    return QSize(400, 110);
+}
+
+int TimelineWidget::plotWidth() const {
+    return std::max(1, width() - kLabelWidth);
+}
+
+double TimelineWidget::fitUsPerPixel() const {
+    return std::max(kMinUsPerPixel, static_cast<double>(m_index.durationUs()) / plotWidth());
+}
+
+void TimelineWidget::setEvents(const std::vector<KeyEvent>& events) {
+    m_index.build(events);
+    m_laneNames.clear();
+    indexChanged();
+}
+
+void TimelineWidget::appendEvents(const KeyEvent* events, size_t count) {
+    m_index.append(events, count);
+    indexChanged();
+}
+
+void TimelineWidget::setIndex(TimelineIndex index) {
+    m_index = std::move(index);
+    m_laneNames.clear();
+    indexChanged();
+}
+
+void TimelineWidget::indexChanged() {
+    // Lanes are only ever added at the end, in order of first use
+    for (size_t lane = m_laneNames.size(); lane < m_index.laneCount(); ++lane) {
+        m_laneNames.push_back(QString::fromStdString(KeyNames::name(m_index.laneKeyId(lane))));
+    }
+
+    if (m_fitted) {
+        zoomToFit();
+    } else {
+        clampView();
+        update();
+    }
+}
+
+void TimelineWidget::zoomToFit() {
+    m_fitted = true;
+    m_startUs = 0.0;
+    m_usPerPixel = fitUsPerPixel();
+    update();
+}
+
+void TimelineWidget::setPlaybackCursor(size_t eventIndex) {
+    // position() is the next event to send; the cursor marks the last one sent
+    const int64_t cursorUs = eventIndex > 0 ? m_index.eventTimeUs(eventIndex - 1) : 0;
+    if (m_hasCursor && cursorUs == m_cursorUs) {
+        return;
+    }
+    m_hasCursor = true;
+    m_cursorUs = cursorUs;
+
+    // Page forward (or back, after a loop) when the cursor leaves the view
+    const double visibleUs = m_usPerPixel * plotWidth();
+    if (!m_dragging && (cursorUs < m_startUs || cursorUs > m_startUs + visibleUs)) {
+        m_startUs = cursorUs - visibleUs * 0.1;
+        clampView();
+    }
+    update();
+}
+
+void TimelineWidget::clearPlaybackCursor() {
+    if (m_hasCursor) {
+        m_hasCursor = false;
+        update();
+    }
+}
+
+void TimelineWidget::clampView() {
+    const double fit = fitUsPerPixel();
+    m_usPerPixel = std::clamp(m_usPerPixel, kMinUsPerPixel, fit);
+    const double visibleUs = m_usPerPixel * plotWidth();
+    m_startUs = std::clamp(m_startUs, 0.0, std::max(0.0, static_cast<double>(m_index.durationUs()) - visibleUs));
+    m_fitted = m_usPerPixel >= fit && m_startUs <= 0.0;
+}
+
+void TimelineWidget::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    if (m_fitted) {
+        m_usPerPixel = fitUsPerPixel();
+    }
+    clampView();
+}
+
+void TimelineWidget::paintEvent(QPaintEvent* /*event*/) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+
+    if (m_index.empty()) {
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, "No sequence recorded.");
+        return;
+    }
+
+    const int plotLeft = kLabelWidth;
+    const int columns = plotWidth();
+    const int laneTop = kAxisHeight;
+    const int laneCount = static_cast<int>(m_index.laneCount());
+    const double laneHeight = static_cast<double>(height() - laneTop) / laneCount;
+
+    const QColor barColor = palette().color(QPalette::Highlight);
+    QColor shades[kAlphaLevels + 1];
+    for (int level = 1; level <= kAlphaLevels; ++level) {
+        shades[level] = barColor;
+        shades[level].setAlphaF(0.25 + 0.75 * level / kAlphaLevels);
+    }
+    const QColor pressColor = barColor.darker(160);
+
+    QFont labelFont = font();
+    labelFont.setPointSizeF(std::max(6.0, std::min(labelFont.pointSizeF(), laneHeight * 0.7)));
+    painter.setFont(labelFont);
+
+    for (int lane = 0; lane < laneCount; ++lane) {
+        const int top = laneTop + static_cast<int>(lane * laneHeight);
+        const int bottom = laneTop + static_cast<int>((lane + 1) * laneHeight);
+        const int barHeight = std::max(1, bottom - top - 1);
+
+        if (laneHeight >= 9.0) {
+            painter.setPen(palette().color(QPalette::Text));
+            painter.drawText(QRect(2, top, kLabelWidth - 4, bottom - top), Qt::AlignVCenter | Qt::AlignLeft,
+                             painter.fontMetrics().elidedText(m_laneNames[lane], Qt::ElideRight, kLabelWidth - 4));
+        }
+        if (lane % 2 == 1) {
+            painter.fillRect(plotLeft, top, columns, bottom - top, palette().alternateBase());
+        }
+
+        m_index.sample(static_cast<size_t>(lane), m_startUs, m_usPerPixel, static_cast<size_t>(columns), &m_columns);
+
+        // Merge neighbouring columns of the same shade into one rectangle
+        int runStart = 0;
+        int runShade = 0;
+        for (int x = 0; x <= columns; ++x) {
+            int shade = 0;
+            if (x < columns) {
+                const TimelineIndex::Column& column = m_columns[x];
+                if (column.coverage > 0.0f || column.presses > 0) {
+                    shade = std::max(1, static_cast<int>(std::ceil(column.coverage * kAlphaLevels)));
+                }
+            }
+            if (shade != runShade) {
+                if (runShade > 0) {
+                    painter.fillRect(plotLeft + runStart, top, x - runStart, barHeight, shades[runShade]);
+                }
+                runStart = x;
+                runShade = shade;
+            }
+        }
+
+        // Press onsets as ticks along the top of the lane when there is room for them
+        if (barHeight >= 6) {
+            painter.setPen(pressColor);
+            for (int x = 0; x < columns; ++x) {
+                if (m_columns[x].presses > 0) {
+                    painter.drawLine(plotLeft + x, top, plotLeft + x, top + 2);
+                }
+            }
+        }
+    }
+
+    paintAxis(painter, plotLeft);
+
+    if (m_hasCursor) {
+        const double x = plotLeft + (m_cursorUs - m_startUs) / m_usPerPixel;
+        if (x >= plotLeft && x <= width()) {
+            painter.setPen(QPen(QColor(220, 50, 47), 2));
+            painter.drawLine(QPointF(x, 0), QPointF(x, height()));
+        }
+    }
+}
+
+void TimelineWidget::paintAxis(QPainter& painter, int plotLeft) const {
+    // 1-2-5 steps, the smallest that keeps labels kMinTickSpacing apart
+    const double minStepUs = m_usPerPixel * kMinTickSpacing;
+    double stepUs = std::pow(10.0, std::floor(std::log10(minStepUs)));
+    if (stepUs * 2 >= minStepUs) {
+        stepUs *= 2;
+    } else if (stepUs * 5 >= minStepUs) {
+        stepUs *= 5;
+    } else {
+        stepUs *= 10;
+    }
+
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawLine(plotLeft, kAxisHeight - 1, width(), kAxisHeight - 1);
+    painter.setPen(palette().color(QPalette::Text));
+    const double endUs = m_startUs + m_usPerPixel * plotWidth();
+    for (double tick = std::ceil(m_startUs / stepUs) * stepUs; tick <= endUs; tick += stepUs) {
+        const int x = plotLeft + static_cast<int>((tick - m_startUs) / m_usPerPixel);
+        painter.drawLine(x, kAxisHeight - 4, x, kAxisHeight - 1);
+        painter.drawText(x + 2, kAxisHeight - 3, formatTime(tick, stepUs));
+    }
+}
+
+void TimelineWidget::wheelEvent(QWheelEvent* event) {
+    if (m_index.empty()) {
+        return;
+    }
+    const QPoint delta = event->angleDelta();
+    const bool pan = (event->modifiers() & Qt::ShiftModifier) || std::abs(delta.x()) > std::abs(delta.y());
+    if (pan) {
+        const int steps = delta.x() != 0 ? delta.x() : delta.y();
+        m_startUs -= steps / 120.0 * plotWidth() * 0.1 * m_usPerPixel;
+    } else {
+        // Keep the time under the pointer where it is
+        const double anchorX = std::max(0.0, event->position().x() - kLabelWidth);
+        const double anchorUs = m_startUs + anchorX * m_usPerPixel;
+        m_usPerPixel *= std::pow(kWheelZoomBase, -delta.y());
+        m_usPerPixel = std::clamp(m_usPerPixel, kMinUsPerPixel, fitUsPerPixel());
+        m_startUs = anchorUs - anchorX * m_usPerPixel;
+    }
+    clampView();
+    update();
+    event->accept();
+}
+
+void TimelineWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        m_dragging = true;
+        m_dragMoved = false;
+        m_dragOriginX = static_cast<int>(event->position().x());
+        m_dragOriginUs = m_startUs;
+        setCursor(Qt::ClosedHandCursor);
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void TimelineWidget::mouseMoveEvent(QMouseEvent* event) {
+    if (m_dragging) {
+        if (std::abs(event->position().x() - m_dragOriginX) >= QApplication::startDragDistance()) {
+            m_dragMoved = true;
+        }
+        m_startUs = m_dragOriginUs - (event->position().x() - m_dragOriginX) * m_usPerPixel;
+        clampView();
+        update();
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void TimelineWidget::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton && m_dragging) {
+        m_dragging = false;
+        unsetCursor();
+        // A click rather than a drag moves playback; the cursor is only shown while playing
+        const double x = event->position().x() - kLabelWidth;
+        if (!m_dragMoved && m_hasCursor && !m_index.empty() && x >= 0.0) {
+            const int64_t timeUs = static_cast<int64_t>(std::llround(m_startUs + x * m_usPerPixel));
+            emit seekRequested(static_cast<quint64>(m_index.eventAtTime(timeUs)));
+        }
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void TimelineWidget::mouseDoubleClickEvent(QMouseEvent* event) {
+    zoomToFit();
+    QWidget::mouseDoubleClickEvent(event);
+}
@@ -0,0 +1,155 @@
+#include "../include/uinputkeyboard.h"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <linux/uinput.h>
+
+namespace { // Use an anonymous namespace to limit scope
+constexpr size_t kMaxBatch = 64;
+
+std::string errnoMessage(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+// Finds the eventN node under /sys/devices/virtual/input/<sysname>
+std::string findEventNode(int fd) {
+    char sysName[64] = {0};
+    if (ioctl(fd, UI_GET_SYSNAME(sizeof(sysName)), sysName) < 0) {
+        return std::string();
+    }
+
+    const std::string sysPath = std::string("/sys/devices/virtual/input/") + sysName;
+    std::string node;
+    if (DIR* dir = opendir(sysPath.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            if (std::strncmp(entry->d_name, "event", 5) == 0) {
+                node = std::string("/dev/input/") + entry->d_name;
+                break;
+            }
+        }
+        closedir(dir);
+    }
+    return node;
+}
+} // end anonymous namespace
+
+UinputKeyboard::~UinputKeyboard() {
+    close();
+}
+
+bool UinputKeyboard::open(std::string* error) {
+    if (isOpen()) {
+        return true;
+    }
+
+    m_fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        if (error) *error = errnoMessage("open /dev/uinput");
+        return false;
+    }
+
+    // Advertise every standard key so any recorded evdev code can be replayed
+    bool ok = ioctl(m_fd, UI_SET_EVBIT, EV_KEY) == 0 && ioctl(m_fd, UI_SET_EVBIT, EV_SYN) == 0;
+    for (int code = KEY_ESC; ok && code <= KEY_MICMUTE; ++code) {
+        ok = ioctl(m_fd, UI_SET_KEYBIT, code) == 0;
+    }
+
+    uinput_setup setup;
+    std::memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1209;  // pid.codes open-source vendor id
+    setup.id.product = 0xC7F7;
+    setup.id.version = 1;
+    std::strncpy(setup.name, kDeviceName, UINPUT_MAX_NAME_SIZE - 1);
+
+    ok = ok && ioctl(m_fd, UI_DEV_SETUP, &setup) == 0 && ioctl(m_fd, UI_DEV_CREATE) == 0;
+    if (!ok) {
+        if (error) *error = errnoMessage("configure uinput device");
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_devicePath = findEventNode(m_fd);
+    return true;
+}
+
+void UinputKeyboard::close() {
+    if (m_fd < 0) {
+        return;
+    }
+    ioctl(m_fd, UI_DEV_DESTROY);
+    ::close(m_fd);
+    m_fd = -1;
+    m_devicePath.clear();
+}
+
+bool UinputKeyboard::send(const uint16_t* codes, const bool* down, size_t count) {
+    if (m_fd < 0) {
+        return false;
+    }
+
+    // Stack buffer for the common case; the kernel stamps each event on write
+    input_event stackEvents[kMaxBatch + 1];
+    std::vector<input_event> heapEvents;
+    input_event* events = stackEvents;
+    if (count > kMaxBatch) {
+        heapEvents.resize(count + 1);
+        events = heapEvents.data();
+    }
+
+    std::memset(events, 0, sizeof(input_event) * (count + 1));
+    for (size_t i = 0; i < count; ++i) {
+        events[i].type = EV_KEY;
+        events[i].code = codes[i];
+        events[i].value = down[i] ? 1 : 0;
+    }
+    events[count].type = EV_SYN;
+    events[count].code = SYN_REPORT;
+
+    const size_t bytes = sizeof(input_event) * (count + 1);
+    ssize_t written;
+    do {
+        written = ::write(m_fd, events, bytes);
+    } while (written < 0 && errno == EINTR);
+    return written == static_cast<ssize_t>(bytes);
+}
+
+input_event UinputKeyboard::keyEvent(uint16_t code, bool down) {
+    input_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.type = EV_KEY;
+    event.code = code;
+    event.value = down ? 1 : 0;
+    return event;
+}
+
+bool UinputKeyboard::sendEvents(const input_event* events, size_t count) {
+    if (m_fd < 0) {
+        return false;
+    }
+
+    input_event syn;
+    std::memset(&syn, 0, sizeof(syn));
+    syn.type = EV_SYN;
+    syn.code = SYN_REPORT;
+
+    iovec parts[2];
+    parts[0].iov_base = const_cast<input_event*>(events);
+    parts[0].iov_len = sizeof(input_event) * count;
+    parts[1].iov_base = &syn;
+    parts[1].iov_len = sizeof(syn);
+
+    const size_t bytes = parts[0].iov_len + parts[1].iov_len;
+    ssize_t written;
+    do {
+        written = ::writev(m_fd, parts, 2);
+    } while (written < 0 && errno == EINTR);
+    return written == static_cast<ssize_t>(bytes);
+}
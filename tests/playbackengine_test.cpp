@@ -0,0 +1,295 @@
+// Runs PlaybackEngine against a LoopbackSink and checks what was injected when playback
+// is controlled from another thread.
+
+#include "../include/loopbacksink.h"
+#include "../include/playbackengine.h"
+#include "testcheck.h"
+
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace { // Use an anonymous namespace to limit scope
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+// The first event goes out at once; the long gap after it is where the tests step in
+std::vector<KeyEvent> seekSequence() {
+    return {
+        makeEvent("a", true, 0),      makeEvent("s", true, 500000), makeEvent("a", false, 1000),
+        makeEvent("d", true, 1000),   makeEvent("s", false, 1000),  makeEvent("d", false, 1000),
+    };
+}
+
+// Plays events once on a helper thread and calls control once the first event is out
+PlaybackEngine::Report playWithControl(const std::vector<KeyEvent>& events, LoopbackSink* sink,
+                                       const std::function<void(PlaybackEngine&)>& control) {
+    PlaybackEngine engine;
+    engine.setPreroll(microseconds(0));
+    PlaybackEngine::Report report;
+    std::thread player([&] { report = engine.run(events, 1, *sink); });
+    while (engine.position() < 1) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    control(engine);
+    player.join();
+    return report;
+}
+
+// Compares the injected keys and states, ignoring delays and timestamps
+bool injected(const LoopbackSink& sink, const std::vector<KeyEvent>& expected) {
+    const std::vector<LoopbackSink::Injected>& events = sink.events();
+    if (events.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i].event.code != expected[i].code || events[i].event.isDown() != expected[i].isDown()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testSeekToStart() {
+    const std::vector<KeyEvent> events = seekSequence();
+    LoopbackSink sink;
+    const PlaybackEngine::Report report = playWithControl(events, &sink, [](PlaybackEngine& engine) {
+        engine.seekToEvent(0);
+    });
+    // "a" is released to match the start, then the whole sequence plays
+    std::vector<KeyEvent> expected = {events[0], makeEvent("a", false, 0)};
+    expected.insert(expected.end(), events.begin(), events.end());
+    CHECK(injected(sink, expected));
+    CHECK(report.completed && report.passes == 1);
+}
+
+void testSeekToMiddle() {
+    const std::vector<KeyEvent> events = seekSequence();
+    LoopbackSink sink;
+    const PlaybackEngine::Report report = playWithControl(events, &sink, [](PlaybackEngine& engine) {
+        engine.seekToEvent(3);
+    });
+    // Only "s" is down before event 3
+    const std::vector<KeyEvent> expected = {
+        events[0], makeEvent("a", false, 0), makeEvent("s", true, 0), events[3], events[4], events[5],
+    };
+    CHECK(injected(sink, expected));
+    CHECK(report.completed && report.passes == 1);
+}
+
+void testSeekToLast() {
+    const std::vector<KeyEvent> events = seekSequence();
+    LoopbackSink sink;
+    const PlaybackEngine::Report report = playWithControl(events, &sink, [](PlaybackEngine& engine) {
+        engine.seekToEvent(5);
+    });
+    const std::vector<KeyEvent> expected = {events[0], makeEvent("a", false, 0), makeEvent("d", true, 0), events[5]};
+    CHECK(injected(sink, expected));
+    CHECK(report.completed && report.passes == 1);
+}
+
+void testSeekPastEnd() {
+    const std::vector<KeyEvent> events = seekSequence();
+    for (size_t target : {events.size(), events.size() + 100}) {
+        LoopbackSink sink;
+        const PlaybackEngine::Report report = playWithControl(events, &sink, [target](PlaybackEngine& engine) {
+            engine.seekToEvent(target);
+        });
+        // The pass ends where it stands, with nothing left held
+        CHECK(injected(sink, {events[0], makeEvent("a", false, 0)}));
+        CHECK(report.completed && report.passes == 1);
+        CHECK(report.eventsSent == 1);
+    }
+
+    // Past the end by time is clamped to the last event
+    LoopbackSink sink;
+    playWithControl(events, &sink, [](PlaybackEngine& engine) { engine.seekToTime(std::chrono::seconds(60)); });
+    CHECK(injected(sink, {events[0], makeEvent("a", false, 0), makeEvent("d", true, 0), events[5]}));
+}
+
+void testSeekPastEndRepeats() {
+    // With passes left, the next one starts after the repeat gap
+    const std::vector<KeyEvent> events = seekSequence();
+    LoopbackSink sink;
+    PlaybackEngine engine;
+    engine.setPreroll(microseconds(0));
+    engine.setRepeatGap(microseconds(0));
+    PlaybackEngine::Report report;
+    std::thread player([&] { report = engine.run(events, 2, sink); });
+    while (engine.position() < 1) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    engine.seekToEvent(events.size());
+    player.join();
+    CHECK(report.completed && report.passes == 2);
+    CHECK(report.eventsSent == 1 + events.size());
+}
+
+void testStopBeforeRun() {
+    // A stop between arm() and run() ends even an endless run before anything is sent
+    const std::vector<KeyEvent> events = seekSequence();
+    LoopbackSink sink;
+    PlaybackEngine engine;
+    engine.setPreroll(microseconds(0));
+    engine.arm();
+    CHECK(engine.isRunning());
+    engine.stop();
+    PlaybackEngine::Report report;
+    std::thread player([&] { report = engine.run(events, PlaybackEngine::kRepeatForever, sink); });
+    player.join();
+    CHECK(!report.completed);
+    CHECK(report.passes == 0);
+    CHECK(sink.events().empty());
+    CHECK(!engine.isRunning());
+
+    // The stop was consumed with that run; the next one plays normally
+    const std::vector<KeyEvent> quick = {makeEvent("a", true, 0), makeEvent("a", false, 1000)};
+    engine.stop();
+    report = engine.run(quick, 2, sink);
+    CHECK(report.completed && report.passes == 2);
+    CHECK(sink.events().size() == 4);
+}
+
+void testArmedRunStops() {
+    // Armed and not stopped, the run goes ahead and stop() ends it as usual
+    const std::vector<KeyEvent> events = seekSequence();
+    LoopbackSink sink;
+    PlaybackEngine engine;
+    engine.setPreroll(microseconds(0));
+    engine.arm();
+    PlaybackEngine::Report report;
+    std::thread player([&] { report = engine.run(events, PlaybackEngine::kRepeatForever, sink); });
+    while (engine.position() < 1) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    engine.stop();
+    player.join();
+    CHECK(!report.completed);
+    CHECK(injected(sink, {events[0], makeEvent("a", false, 0)}));
+}
+
+void testControlBeforeRun() {
+    // A seek made between arm() and run() picks the first event
+    const std::vector<KeyEvent> events = seekSequence();
+    {
+        LoopbackSink sink;
+        PlaybackEngine engine;
+        engine.setPreroll(microseconds(0));
+        engine.arm();
+        engine.seekToEvent(3);
+        const PlaybackEngine::Report report = engine.run(events, 1, sink);
+        CHECK(injected(sink, {makeEvent("s", true, 0), events[3], events[4], events[5]}));
+        CHECK(report.completed && report.passes == 1);
+    }
+
+    // A seek to the end finishes the first pass at once
+    {
+        LoopbackSink sink;
+        PlaybackEngine engine;
+        engine.setPreroll(microseconds(0));
+        engine.arm();
+        engine.seekToEvent(events.size() + 5);
+        const PlaybackEngine::Report report = engine.run(events, 1, sink);
+        CHECK(sink.events().empty());
+        CHECK(report.completed && report.passes == 1);
+    }
+
+    // A pause holds the run before its first event until resumed
+    {
+        LoopbackSink sink;
+        PlaybackEngine engine;
+        engine.setPreroll(microseconds(0));
+        engine.arm();
+        engine.pause();
+        PlaybackEngine::Report report;
+        std::thread player([&] { report = engine.run(events, 1, sink); });
+        while (!engine.isPaused()) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        std::this_thread::sleep_for(milliseconds(20));
+        CHECK(sink.events().empty());
+        engine.resume();
+        player.join();
+        CHECK(injected(sink, events));
+        CHECK(report.completed && report.passes == 1);
+    }
+
+    // Requests from before arm() are dropped, so an old pause does not hold a new run
+    {
+        LoopbackSink sink;
+        PlaybackEngine engine;
+        engine.setPreroll(microseconds(0));
+        engine.pause();
+        engine.seekToEvent(3);
+        engine.arm();
+        CHECK(engine.run({makeEvent("a", true, 0), makeEvent("a", false, 0)}, 1, sink).completed);
+        CHECK(sink.events().size() == 2);
+    }
+}
+
+void testDisarm() {
+    // A run that was armed but never started leaves nothing behind for the next one
+    LoopbackSink sink;
+    PlaybackEngine engine;
+    engine.setPreroll(microseconds(0));
+    engine.arm();
+    engine.disarm();
+    CHECK(!engine.isRunning());
+    engine.stop();
+    const PlaybackEngine::Report report = engine.run({makeEvent("a", true, 0), makeEvent("a", false, 1000)}, 1, sink);
+    CHECK(report.completed && report.passes == 1);
+    CHECK(sink.events().size() == 2);
+}
+
+void testSinkSettleTime() {
+    // A sink that needs time after open() holds the first event back even with no preroll
+    struct SettlingSink : LoopbackSink {
+        std::chrono::microseconds settleTime() const override { return milliseconds(30); }
+    };
+    SettlingSink sink;
+    PlaybackEngine engine;
+    engine.setPreroll(microseconds(0));
+    const PlaybackEngine::Report report = engine.run({makeEvent("a", true, 0), makeEvent("a", false, 0)}, 1, sink);
+    CHECK(report.preroll == milliseconds(30));
+    CHECK(sink.events().size() == 2);
+    if (!sink.events().empty()) {
+        const auto sentAt = PlaybackClock::TimePoint(std::chrono::nanoseconds(sink.events()[0].timestampNs));
+        CHECK(sentAt >= report.origin + milliseconds(30));
+    }
+
+    // A longer preroll wins
+    engine.setPreroll(milliseconds(40));
+    CHECK(engine.run({makeEvent("a", true, 0)}, 1, sink).preroll == milliseconds(40));
+}
+
+void testCountingSink() {
+    // A sink that only counts keeps nothing, however many passes are played
+    LoopbackSink sink(0, false);
+    PlaybackEngine engine;
+    engine.setPreroll(microseconds(0));
+    engine.setRepeatGap(microseconds(0));
+    const PlaybackEngine::Report report =
+        engine.run({makeEvent("a", true, 0), makeEvent("a", false, 100)}, 50, sink);
+    CHECK(report.completed && report.passes == 50);
+    CHECK(sink.sentCount() == 100);
+    CHECK(sink.events().empty());
+}
+
+} // end anonymous namespace
+
+int main() {
+    testSeekToStart();
+    testSeekToMiddle();
+    testSeekToLast();
+    testSeekPastEnd();
+    testSeekPastEndRepeats();
+    testStopBeforeRun();
+    testArmedRunStops();
+    testControlBeforeRun();
+    testDisarm();
+    testSinkSettleTime();
+    testCountingSink();
+    return testResult("playbackengine_test");
+}
@@ -0,0 +1,116 @@
+// Checks PlaybackTape compilation: timing rules, batching and the seek lookups.
+
+#include "../include/playbacktape.h"
+#include "testcheck.h"
+
+#include <chrono>
+#include <vector>
+
+namespace { // Use an anonymous namespace to limit scope
+
+using std::chrono::microseconds;
+
+PlaybackTape compileTape(const std::vector<KeyEvent>& events, const PlaybackTiming& timing = {},
+                         microseconds threshold = microseconds(1000), size_t maxBatch = 64) {
+    return PlaybackTape::compile(events, timing, threshold, maxBatch);
+}
+
+void testOffsetsAndBatches() {
+    // A chord (two zero-delay followers), a follower inside the threshold, then a lone key
+    const std::vector<KeyEvent> events = {
+        makeEvent("a", true, 10000), makeEvent("s", true, 0), makeEvent("d", true, 0),
+        makeEvent("f", true, 800), makeEvent("a", false, 5000), makeEvent("s", false, 1500),
+    };
+    const PlaybackTape tape = compileTape(events);
+    CHECK(tape.eventCount == events.size());
+    CHECK((tape.eventOffsetsUs == std::vector<int64_t>{10000, 10000, 10000, 10800, 15800, 17300}));
+    CHECK(tape.durationUs == 17300);
+
+    CHECK(tape.batches.size() == 3);
+    if (tape.batches.size() == 3) {
+        CHECK(tape.batches[0].first == 0 && tape.batches[0].count == 4 && tape.batches[0].offsetUs == 10000);
+        CHECK(tape.batches[1].first == 4 && tape.batches[1].count == 1);
+        CHECK(tape.batches[2].first == 5 && tape.batches[2].count == 1);
+    }
+
+    // Zero threshold only joins events with no delay between them
+    const PlaybackTape strict = compileTape(events, {}, microseconds(0));
+    CHECK(strict.batches.size() == 4);
+}
+
+void testMaxBatch() {
+    std::vector<KeyEvent> events;
+    for (int i = 0; i < 10; ++i) {
+        events.push_back(makeEvent("a", i % 2 == 0, 0));
+    }
+    const PlaybackTape tape = compileTape(events, {}, microseconds(1000), 4);
+    CHECK(tape.batches.size() == 3);
+    if (tape.batches.size() == 3) {
+        CHECK(tape.batches[0].count == 4 && tape.batches[1].count == 4 && tape.batches[2].count == 2);
+    }
+}
+
+void testTimingRules() {
+    const std::vector<KeyEvent> events = {
+        makeEvent("a", true, 2000000), makeEvent("a", false, 1000), makeEvent("s", true, 400000),
+    };
+
+    PlaybackTiming faster;
+    faster.speed = 2.0;
+    CHECK((compileTape(events, faster).eventOffsetsUs == std::vector<int64_t>{1000000, 1000500, 1200500}));
+
+    PlaybackTiming idle;
+    idle.idleThresholdUs = 1000000;
+    idle.idleGapUs = 50000;
+    idle.maxGapUs = 300000;
+    CHECK((compileTape(events, idle).eventOffsetsUs == std::vector<int64_t>{50000, 51000, 351000}));
+
+    // Rounding is applied to the running total: a million 1000 us gaps at 3x come to
+    // exactly a third of the unscaled length, not a million gaps of 333 us
+    std::vector<KeyEvent> steady;
+    for (int i = 0; i < 1000000; ++i) {
+        steady.push_back(makeEvent("a", i % 2 == 0, 1000));
+    }
+    PlaybackTiming triple;
+    triple.speed = 3.0;
+    CHECK(compileTape(steady, triple).durationUs == 333333333);
+
+    // The release moves out to the minimum hold and everything after it follows
+    PlaybackTiming hold;
+    hold.minHoldUs = 20000;
+    CHECK((compileTape(events, hold).eventOffsetsUs == std::vector<int64_t>{2000000, 2020000, 2420000}));
+}
+
+void testSeekLookups() {
+    const std::vector<KeyEvent> events = sampleSequence(600);
+    const PlaybackTape tape = compileTape(events);
+
+    CHECK(tape.eventAtOffset(0) == 0);
+    CHECK(tape.eventAtOffset(tape.eventOffsetsUs[700]) <= 700);
+    CHECK(tape.eventOffsetsUs[tape.eventAtOffset(tape.eventOffsetsUs[700])] == tape.eventOffsetsUs[700]);
+    CHECK(tape.eventAtOffset(tape.durationUs + 1) == events.size());
+
+    for (size_t i : {size_t(0), size_t(1), size_t(255), size_t(256), size_t(700), events.size() - 1}) {
+        const PlaybackTape::Batch& batch = tape.batches[tape.batchContaining(i)];
+        CHECK(batch.first <= i && i < batch.first + batch.count);
+    }
+
+    // Held keys match a straight replay of the events, across checkpoints
+    for (size_t index : {size_t(0), size_t(255), size_t(257), events.size() - 4, events.size()}) {
+        HeldKeySet expected;
+        for (size_t i = 0; i < index; ++i) {
+            expected.set(events[i].code, events[i].isDown());
+        }
+        CHECK(tape.heldBefore(events, index) == expected);
+    }
+}
+
+} // end anonymous namespace
+
+int main() {
+    testOffsetsAndBatches();
+    testMaxBatch();
+    testTimingRules();
+    testSeekLookups();
+    return testResult("playbacktape_test");
+}
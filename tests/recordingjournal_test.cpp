@@ -0,0 +1,127 @@
+// Writes recording journals and recovers them, intact and after the kinds of damage a
+// crash leaves behind: a final block cut short or a block whose bytes never hit the disk.
+
+#include "../include/recordingjournal.h"
+#include "testcheck.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace { // Use an anonymous namespace to limit scope
+
+namespace fs = std::filesystem;
+
+// Key ids are not stored, so recovery resolves them again from the codes
+uint16_t resolveKey(uint16_t code) {
+    const std::string_view name = KeyTables::nameForCode(code);
+    return name.empty() ? KeyNames::kUnknown : KeyNames::intern(std::string(name));
+}
+
+fs::path journalPath(const char* name) {
+    return fs::temp_directory_path() / ("craftium_test_" + std::to_string(getpid())) / name;
+}
+
+std::vector<uint8_t> readFile(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const fs::path& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Journals the events in appends of chunk events each
+void writeJournal(const fs::path& path, const std::vector<KeyEvent>& events, size_t chunk) {
+    RecordingJournal journal;
+    std::string error;
+    CHECK(journal.open(path, &error));
+    for (size_t first = 0; first < events.size(); first += chunk) {
+        journal.append(events.data() + first, std::min(chunk, events.size() - first));
+    }
+    journal.close();
+    CHECK(!journal.failed());
+    CHECK(journal.committedEvents() == events.size());
+}
+
+// What recovery should give back for the first count events: the key ids come from the codes
+std::vector<KeyEvent> expected(const std::vector<KeyEvent>& events, size_t count) {
+    std::vector<KeyEvent> out(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(count));
+    for (KeyEvent& event : out) {
+        event.keyId = resolveKey(event.code);
+    }
+    return out;
+}
+
+void testRoundTrip() {
+    const fs::path path = journalPath("roundtrip.journal");
+    const std::vector<KeyEvent> events = sampleSequence(1500);
+    writeJournal(path, events, 7);
+
+    RecordingJournal::Recovered recovered;
+    CHECK(RecordingJournal::recover(path, resolveKey, &recovered));
+    CHECK(!recovered.tornTail);
+    CHECK(recovered.startedAtUnix > 0);
+    CHECK(sameEvents(recovered.events, expected(events, events.size())));
+
+    RecordingJournal::discard(path);
+    CHECK(!fs::exists(path));
+    CHECK(!RecordingJournal::recover(path, resolveKey, &recovered));
+}
+
+void testTornTail() {
+    const fs::path path = journalPath("torn.journal");
+    // One append per block's worth, so the file holds whole blocks and a short last one
+    const std::vector<KeyEvent> events = sampleSequence(1100);
+    writeJournal(path, events, RecordingJournal::kBlockEvents);
+    const std::vector<uint8_t> intact = readFile(path);
+
+    // Cut anywhere inside the last block: every earlier block survives
+    const size_t lastBlockEvents = events.size() % RecordingJournal::kBlockEvents;
+    const size_t lastBlockBytes = 16 + lastBlockEvents * 8;
+    const size_t keptEvents = events.size() - lastBlockEvents;
+    for (size_t cut : {size_t(1), size_t(8), lastBlockBytes - 17, lastBlockBytes - 1}) {
+        writeFile(path, std::vector<uint8_t>(intact.begin(), intact.end() - static_cast<std::ptrdiff_t>(cut)));
+        RecordingJournal::Recovered recovered;
+        CHECK(RecordingJournal::recover(path, resolveKey, &recovered));
+        CHECK(recovered.tornTail);
+        CHECK(sameEvents(recovered.events, expected(events, keptEvents)));
+    }
+
+    // A block that reached the file as zeros (metadata written, data lost) ends recovery there
+    std::vector<uint8_t> zeroed = intact;
+    std::fill(zeroed.end() - static_cast<std::ptrdiff_t>(lastBlockBytes), zeroed.end(), 0);
+    writeFile(path, zeroed);
+    RecordingJournal::Recovered recovered;
+    CHECK(RecordingJournal::recover(path, resolveKey, &recovered));
+    CHECK(recovered.tornTail);
+    CHECK(sameEvents(recovered.events, expected(events, keptEvents)));
+
+    // A flipped bit in an event fails that block's checksum
+    std::vector<uint8_t> flipped = intact;
+    flipped[flipped.size() - 3] ^= 0x01;
+    writeFile(path, flipped);
+    CHECK(RecordingJournal::recover(path, resolveKey, &recovered));
+    CHECK(recovered.tornTail);
+    CHECK(recovered.events.size() == keptEvents);
+
+    // Nothing but a header is not a recording
+    writeFile(path, std::vector<uint8_t>(intact.begin(), intact.begin() + 24));
+    CHECK(!RecordingJournal::recover(path, resolveKey, &recovered));
+    RecordingJournal::discard(path);
+}
+
+} // end anonymous namespace
+
+int main() {
+    testRoundTrip();
+    testTornTail();
+    std::error_code ignored;
+    fs::remove_all(journalPath("").parent_path(), ignored);
+    return testResult("recordingjournal_test");
+}
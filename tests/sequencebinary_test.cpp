@@ -0,0 +1,143 @@
+// Round-trips sequences through the .crft encoder and reader, and checks that truncated
+// or corrupted images are rejected instead of decoded.
+
+#include "../include/sequencebinary.h"
+#include "testcheck.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace { // Use an anonymous namespace to limit scope
+
+void putU32(std::vector<uint8_t>& image, size_t offset, uint32_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+        image[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+// Rewrites the checksum the way a version 2 writer would, so a damaged header gets past it
+void resign(std::vector<uint8_t>& image) {
+    const uint32_t headerCrc = SequenceBinary::crc32(image.data() + 4, 32);
+    putU32(image, 36, SequenceBinary::crc32(image.data() + SequenceBinary::kHeaderSize,
+                                            image.size() - SequenceBinary::kHeaderSize, headerCrc));
+}
+
+bool decodeImage(const std::vector<uint8_t>& image, std::vector<KeyEvent>* events) {
+    SequenceBinary::Reader reader;
+    return reader.open(image.data(), image.size()) && reader.decode(events);
+}
+
+void testRoundTrip() {
+    const std::vector<KeyEvent> events = sampleSequence();
+    const std::vector<uint8_t> image = SequenceBinary::encode(events);
+    CHECK(SequenceBinary::isBinary(image.data(), image.size()));
+
+    SequenceBinary::Reader reader;
+    std::string error;
+    CHECK(reader.open(image.data(), image.size(), &error));
+    CHECK(reader.header().eventCount == events.size());
+    CHECK(reader.header().platform == SequenceBinary::currentPlatform());
+    uint64_t durationUs = 0;
+    for (const KeyEvent& event : events) {
+        durationUs += event.delayUs;
+    }
+    CHECK(reader.header().durationUs == durationUs);
+    CHECK(reader.header().version == SequenceBinary::kVersion);
+
+    std::vector<KeyEvent> decoded;
+    CHECK(reader.decode(&decoded, &error));
+    CHECK(sameEvents(decoded, events));
+}
+
+void testEmpty() {
+    const std::vector<uint8_t> image = SequenceBinary::encode({});
+    CHECK(image.size() == SequenceBinary::kHeaderSize);
+    std::vector<KeyEvent> decoded;
+    CHECK(decodeImage(image, &decoded));
+    CHECK(decoded.empty());
+}
+
+void testCancelAppendsNothing() {
+    const std::vector<KeyEvent> events = sampleSequence(5000);
+    const std::vector<uint8_t> image = SequenceBinary::encode(events);
+    SequenceBinary::Reader reader;
+    CHECK(reader.open(image.data(), image.size()));
+
+    std::vector<KeyEvent> decoded(3);
+    CHECK(!reader.decode(&decoded, nullptr, [](size_t done, size_t) { return done == 0; }));
+    CHECK(decoded.size() == 3);
+}
+
+void testDamagedImages() {
+    const std::vector<uint8_t> image = SequenceBinary::encode(sampleSequence());
+    std::vector<KeyEvent> decoded;
+
+    std::vector<uint8_t> truncated(image.begin(), image.end() - 1);
+    CHECK(!decodeImage(truncated, &decoded));
+
+    std::vector<uint8_t> flipped = image;
+    flipped[flipped.size() / 2] ^= 0x40;
+    CHECK(!decodeImage(flipped, &decoded));
+
+    std::vector<uint8_t> newer = image;
+    newer[4] = static_cast<uint8_t>(SequenceBinary::kVersion + 1);
+    CHECK(!decodeImage(newer, &decoded));
+
+    // Header fields are checksummed too: a changed duration is caught
+    std::vector<uint8_t> duration = image;
+    duration[28] ^= 0x01;
+    CHECK(!decodeImage(duration, &decoded));
+    CHECK(decoded.empty());
+}
+
+void testHugeCounts() {
+    // Counts the sections cannot hold are rejected before anything is sized from them,
+    // even with a checksum that matches
+    const std::vector<uint8_t> image = SequenceBinary::encode(sampleSequence());
+    std::string error;
+    for (size_t offset : {size_t(8), size_t(12)}) {
+        std::vector<uint8_t> huge = image;
+        putU32(huge, offset, 0xFFFFFFFFu);
+        resign(huge);
+        SequenceBinary::Reader reader;
+        CHECK(!reader.open(huge.data(), huge.size(), &error));
+        CHECK(error == "Sequence file header is corrupt.");
+    }
+}
+
+void testVersion1() {
+    // Version 1 files checksum the sections only and still load
+    const std::vector<KeyEvent> events = sampleSequence();
+    std::vector<uint8_t> image = SequenceBinary::encode(events);
+    image[4] = 1;
+    image[5] = 0;
+    putU32(image, 36, SequenceBinary::crc32(image.data() + SequenceBinary::kHeaderSize,
+                                            image.size() - SequenceBinary::kHeaderSize));
+    std::vector<KeyEvent> decoded;
+    CHECK(decodeImage(image, &decoded));
+    CHECK(sameEvents(decoded, events));
+}
+
+void testChainedCrc() {
+    const std::vector<uint8_t> image = SequenceBinary::encode(sampleSequence());
+    const size_t half = image.size() / 2;
+    CHECK(SequenceBinary::crc32(image.data() + half, image.size() - half, SequenceBinary::crc32(image.data(), half))
+          == SequenceBinary::crc32(image.data(), image.size()));
+    // The standard check value for "123456789"
+    const char* check = "123456789";
+    CHECK(SequenceBinary::crc32(reinterpret_cast<const uint8_t*>(check), std::strlen(check)) == 0xCBF43926u);
+}
+
+} // end anonymous namespace
+
+int main() {
+    testRoundTrip();
+    testEmpty();
+    testCancelAppendsNothing();
+    testDamagedImages();
+    testHugeCounts();
+    testVersion1();
+    testChainedCrc();
+    return testResult("sequencebinary_test");
+}
@@ -0,0 +1,89 @@
+// Round-trips sequences through the streaming JSON writer and parser, including files
+// from another platform and malformed input.
+
+#include "../include/sequencejson.h"
+#include "testcheck.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace { // Use an anonymous namespace to limit scope
+
+constexpr const char* kCodeField = "testKeyCode";
+
+std::string writeJson(const std::vector<KeyEvent>& events) {
+    std::string json;
+    const bool written = SequenceJson::write(events, kCodeField, [&json](const char* data, size_t size) {
+        json.append(data, size);
+        return true;
+    });
+    CHECK(written);
+    return json;
+}
+
+bool parseJson(const std::string& json, const char* codeField, std::vector<KeyEvent>* events,
+               std::string* error = nullptr) {
+    return SequenceJson::parse(json.data(), json.size(), codeField, events, error);
+}
+
+void testRoundTrip() {
+    const std::vector<KeyEvent> events = sampleSequence();
+    const std::string json = writeJson(events);
+
+    std::vector<KeyEvent> parsed;
+    std::string error;
+    CHECK(parseJson(json, kCodeField, &parsed, &error));
+    CHECK(sameEvents(parsed, events));
+
+    // Writing the parsed events again gives the same bytes
+    CHECK(writeJson(parsed) == json);
+}
+
+void testEmpty() {
+    std::vector<KeyEvent> parsed(2);
+    CHECK(parseJson(writeJson({}), kCodeField, &parsed));
+    CHECK(parsed.empty());
+}
+
+void testOtherPlatformResolvesNames() {
+    // Without this platform's code field, codes come from the key name
+    const std::string json = "[ { \"key\": \"a\", \"state\": \"down\", \"delay\": 5, \"otherKeyCode\": 999 },"
+                             "  { \"key\": \"a\", \"state\": \"up\", \"delayUs\": 1234, \"extra\": [1, {\"x\": 2}] } ]";
+    std::vector<KeyEvent> parsed;
+    CHECK(parseJson(json, kCodeField, &parsed));
+    CHECK(parsed.size() == 2);
+    if (parsed.size() == 2) {
+        CHECK(sameEvent(parsed[0], makeEvent("a", true, 5000)));
+        CHECK(sameEvent(parsed[1], makeEvent("a", false, 1234)));
+    }
+}
+
+void testMalformedLeavesEventsUntouched() {
+    const std::string json = writeJson(sampleSequence(10));
+    std::vector<KeyEvent> parsed(1);
+    CHECK(!parseJson(json.substr(0, json.size() / 2), kCodeField, &parsed));
+    CHECK(!parseJson("{ \"key\": \"a\" }", kCodeField, &parsed));
+    CHECK(parsed.size() == 1);
+}
+
+void testCancel() {
+    const std::string json = writeJson(sampleSequence(5000));
+    std::vector<KeyEvent> parsed;
+    std::string error;
+    CHECK(!SequenceJson::parse(json.data(), json.size(), kCodeField, &parsed, &error,
+                               [](size_t, size_t) { return false; }));
+    CHECK(error == SequenceJson::kCancelled);
+    CHECK(parsed.empty());
+}
+
+} // end anonymous namespace
+
+int main() {
+    testRoundTrip();
+    testEmpty();
+    testOtherPlatformResolvesNames();
+    testMalformedLeavesEventsUntouched();
+    testCancel();
+    return testResult("sequencejson_test");
+}
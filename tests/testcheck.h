@@ -0,0 +1,80 @@
+#ifndef TESTCHECK_H
+#define TESTCHECK_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "../include/keyevent.h"
+#include "../include/keytables.h"
+
+// Minimal checks for the Qt-free tests. Each test is its own executable: a failed CHECK
+// prints its location and the test keeps going, then main() returns testResult().
+
+// ctest treats this exit code as a skipped test (SKIP_RETURN_CODE)
+constexpr int kTestSkipped = 77;
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++testFailures();                                                         \
+        }                                                                             \
+    } while (0)
+
+inline int testResult(const char* name) {
+    if (testFailures() > 0) {
+        std::fprintf(stderr, "%s: %d check(s) failed\n", name, testFailures());
+        return 1;
+    }
+    std::printf("%s: passed\n", name);
+    return 0;
+}
+
+// An event for a key from this platform's table, as the recorder would produce it
+inline KeyEvent makeEvent(const char* keyName, bool isDown, uint32_t delayUs) {
+    const int code = KeyTables::codeForName(keyName);
+    return KeyEvent(KeyNames::intern(keyName), static_cast<uint16_t>(code < 0 ? 0 : code), isDown, delayUs);
+}
+
+inline bool sameEvent(const KeyEvent& a, const KeyEvent& b) {
+    return a.delayUs == b.delayUs && a.keyId == b.keyId && a.code == b.code && a.isDown() == b.isDown();
+}
+
+inline bool sameEvents(const std::vector<KeyEvent>& a, const std::vector<KeyEvent>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!sameEvent(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Typing, a chord with zero-delay followers, auto-repeat and delays from zero up to the
+// 32-bit limit, so every varint width and both key states are covered
+inline std::vector<KeyEvent> sampleSequence(size_t typingPairs = 1000) {
+    static const char* const keys[] = {"a", "s", "d", "f", "space", "enter"};
+    std::vector<KeyEvent> events;
+    for (size_t i = 0; i < typingPairs; ++i) {
+        const char* key = keys[i % 6];
+        events.push_back(makeEvent(key, true, static_cast<uint32_t>(40000 + (i * 7919) % 90000)));
+        events.push_back(makeEvent(key, false, static_cast<uint32_t>(60000 + (i * 104729) % 30000)));
+    }
+    events.push_back(makeEvent("shift", true, 250000));
+    events.push_back(makeEvent("a", true, 0));
+    events.push_back(makeEvent("a", true, 33000));  // Auto-repeat
+    events.push_back(makeEvent("a", false, 0));
+    events.push_back(makeEvent("shift", false, 0));
+    events.push_back(makeEvent("d", true, UINT32_MAX));
+    events.push_back(makeEvent("d", false, 1));
+    return events;
+}
+
+#endif // TESTCHECK_H
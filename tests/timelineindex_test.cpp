@@ -0,0 +1,212 @@
+// Checks the TimelineIndex lookups the timeline uses to place the playback cursor and to
+// turn a click into a seek target, and compares what sample() draws, from the bucket
+// pyramid and from the raw intervals, against intervals worked out from the events.
+
+#include "../include/timelineindex.h"
+#include "testcheck.h"
+
+#include <cmath>
+#include <vector>
+
+namespace { // Use an anonymous namespace to limit scope
+
+// 2^22 us: with power-of-two buckets, columns of kColumnUs line up with pyramid level 4
+constexpr int64_t kDurationUs = int64_t(1) << 22;
+constexpr double kColumnUs = 16384.0;
+
+struct Interval {
+    int64_t downUs;
+    int64_t upUs;
+};
+
+// "a" typed often enough to get a pyramid, with the odd auto-repeat; "b" held from the
+// first event to the last; "s" pressed at the very end and never released
+std::vector<KeyEvent> timelineSequence() {
+    std::vector<KeyEvent> events;
+    events.push_back(makeEvent("b", true, 100));
+    int64_t timeUs = 100;
+    uint32_t seed = 12345;
+    auto next = [&seed](uint32_t range) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) % range;
+    };
+    for (int i = 0; i < 2000; ++i) {
+        const uint32_t down = 300 + next(800);
+        const uint32_t up = 200 + next(700);
+        events.push_back(makeEvent("a", true, down));
+        if (i % 50 == 0) {
+            events.push_back(makeEvent("a", true, 0));  // Auto-repeat
+        }
+        events.push_back(makeEvent("a", false, up));
+        timeUs += down + up;
+    }
+    events.push_back(makeEvent("b", false, static_cast<uint32_t>(kDurationUs - timeUs)));
+    events.push_back(makeEvent("s", true, 0));
+    return events;
+}
+
+// Down/up intervals of one key, worked out independently of the index
+std::vector<Interval> intervalsOf(const std::vector<KeyEvent>& events, uint16_t keyId) {
+    std::vector<Interval> intervals;
+    int64_t timeUs = 0;
+    int64_t heldSince = -1;
+    for (const KeyEvent& event : events) {
+        timeUs += event.delayUs;
+        if (event.keyId != keyId) {
+            continue;
+        }
+        if (event.isDown() && heldSince < 0) {
+            heldSince = timeUs;
+        } else if (!event.isDown() && heldSince >= 0) {
+            intervals.push_back({heldSince, timeUs});
+            heldSince = -1;
+        }
+    }
+    if (heldSince >= 0) {
+        intervals.push_back({heldSince, timeUs});
+    }
+    return intervals;
+}
+
+// Coverage and presses of each column straight from the intervals
+std::vector<TimelineIndex::Column> reference(const std::vector<Interval>& intervals, double startUs,
+                                             double usPerColumn, size_t columnCount) {
+    std::vector<TimelineIndex::Column> columns(columnCount);
+    for (size_t c = 0; c < columnCount; ++c) {
+        const double columnStart = startUs + static_cast<double>(c) * usPerColumn;
+        const double columnEnd = columnStart + usPerColumn;
+        double heldUs = 0.0;
+        for (const Interval& interval : intervals) {
+            heldUs += std::max(0.0, std::min<double>(interval.upUs, columnEnd) - std::max<double>(interval.downUs, columnStart));
+            if (interval.downUs >= columnStart && interval.downUs < columnEnd) {
+                columns[c].presses++;
+            }
+        }
+        columns[c].coverage = static_cast<float>(std::min(1.0, heldUs / usPerColumn));
+    }
+    return columns;
+}
+
+bool sameColumns(const std::vector<TimelineIndex::Column>& a, const std::vector<TimelineIndex::Column>& b,
+                 float tolerance) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].presses != b[i].presses || std::fabs(a[i].coverage - b[i].coverage) > tolerance) {
+            std::fprintf(stderr, "column %zu: presses %u vs %u, coverage %f vs %f\n", i, a[i].presses,
+                         b[i].presses, a[i].coverage, b[i].coverage);
+            return false;
+        }
+    }
+    return true;
+}
+
+void testLookups() {
+    const std::vector<KeyEvent> events = {
+        makeEvent("a", true, 1000), makeEvent("s", true, 0), makeEvent("a", false, 500), makeEvent("s", false, 2500),
+    };
+    TimelineIndex index;
+    index.build(events);
+    CHECK(index.durationUs() == 4000);
+    CHECK(index.laneCount() == 2);
+    CHECK(index.eventCount() == events.size());
+
+    CHECK(index.eventTimeUs(0) == 1000);
+    CHECK(index.eventTimeUs(2) == 1500);
+    CHECK(index.eventTimeUs(events.size()) == index.durationUs());
+
+    // A click lands on the first event at or after it; events sharing a time resolve to the first
+    CHECK(index.eventAtTime(0) == 0);
+    CHECK(index.eventAtTime(1000) == 0);
+    CHECK(index.eventAtTime(1001) == 2);
+    CHECK(index.eventAtTime(4000) == 3);
+    CHECK(index.eventAtTime(4001) == events.size());
+
+    index.clear();
+    CHECK(index.empty());
+    CHECK(index.eventAtTime(0) == 0);
+}
+
+void testSampleMatchesIntervals() {
+    const std::vector<KeyEvent> events = timelineSequence();
+    TimelineIndex index;
+    index.build(events);
+    CHECK(index.durationUs() == kDurationUs);
+    CHECK(index.laneCount() == 3);
+
+    std::vector<TimelineIndex::Column> columns;
+    for (size_t lane = 0; lane < index.laneCount(); ++lane) {
+        const std::vector<Interval> intervals = intervalsOf(events, index.laneKeyId(lane));
+
+        // Fully zoomed out: "a" is drawn from the pyramid, the others from their intervals
+        const size_t fitColumns = static_cast<size_t>(kDurationUs / kColumnUs) + 1;
+        index.sample(lane, 0.0, kColumnUs, fitColumns, &columns);
+        CHECK(sameColumns(columns, reference(intervals, 0.0, kColumnUs, fitColumns), 1e-4f));
+
+        // Zoomed in past level 0: raw intervals, starting part way through a column
+        index.sample(lane, 1234567.0, 37.0, 500, &columns);
+        CHECK(sameColumns(columns, reference(intervals, 1234567.0, 37.0, 500), 1e-4f));
+    }
+
+    // Every press of "a" (lane 1, after "b") is counted once when zoomed out
+    index.sample(1, 0.0, kColumnUs, static_cast<size_t>(kDurationUs / kColumnUs) + 1, &columns);
+    uint64_t presses = 0;
+    for (const TimelineIndex::Column& column : columns) {
+        presses += column.presses;
+    }
+    CHECK(presses == intervalsOf(events, index.laneKeyId(1)).size());
+}
+
+void testAppendMatchesBuild() {
+    // Appending in uneven pieces, with keys held across the joins and the pyramid starting
+    // part way through, gives the same picture as one build
+    const std::vector<KeyEvent> events = timelineSequence();
+    TimelineIndex built;
+    built.build(events);
+
+    TimelineIndex appended;
+    const size_t pieces[] = {1, 2, 7, 300, 1, 1500, 64};
+    size_t done = 0;
+    for (size_t i = 0; done < events.size(); ++i) {
+        const size_t count = std::min(pieces[i % 7], events.size() - done);
+        appended.append(events.data() + done, count);
+        done += count;
+    }
+    CHECK(appended.eventCount() == built.eventCount());
+    CHECK(appended.durationUs() == built.durationUs());
+    CHECK(appended.laneCount() == built.laneCount());
+
+    std::vector<TimelineIndex::Column> a;
+    std::vector<TimelineIndex::Column> b;
+    for (size_t lane = 0; lane < built.laneCount(); ++lane) {
+        CHECK(appended.laneKeyId(lane) == built.laneKeyId(lane));
+        const size_t fitColumns = static_cast<size_t>(kDurationUs / kColumnUs) + 1;
+        built.sample(lane, 0.0, kColumnUs, fitColumns, &a);
+        appended.sample(lane, 0.0, kColumnUs, fitColumns, &b);
+        CHECK(sameColumns(a, b, 0.0f));
+        built.sample(lane, 1000000.0, 3000.0, 700, &a);
+        appended.sample(lane, 1000000.0, 3000.0, 700, &b);
+        CHECK(sameColumns(a, b, 0.0f));
+    }
+}
+
+void testPressAtViewEnd() {
+    // 61 < 5 * usPerColumn, but 61 / usPerColumn rounds to 5: the press belongs to the last column
+    TimelineIndex index;
+    index.build({makeEvent("a", true, 61), makeEvent("a", false, 9)});
+    std::vector<TimelineIndex::Column> columns;
+    index.sample(0, 0.0, std::nextafter(61.0 / 5, 100.0), 5, &columns);
+    CHECK(columns.size() == 5);
+    CHECK(columns[4].presses == 1);
+}
+
+} // end anonymous namespace
+
+int main() {
+    testLookups();
+    testSampleMatchesIntervals();
+    testAppendMatchesBuild();
+    testPressAtViewEnd();
+    return testResult("timelineindex_test");
+}
@@ -0,0 +1,133 @@
+// Injects through a uinput virtual keyboard and reads the events back from the device's
+// /dev/input/event* node, checking their order and the latency from write to delivery.
+// Skipped where /dev/uinput is not writable or the node cannot be read, as in most
+// containers; on a replay machine run it as a member of the input group.
+
+#include "../include/uinputkeyboard.h"
+#include "testcheck.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace { // Use an anonymous namespace to limit scope
+
+constexpr std::chrono::milliseconds kNodeWait{2000};   // udev creates the node a little after UI_DEV_CREATE
+constexpr std::chrono::milliseconds kReadTimeout{1000};
+constexpr int64_t kMaxLatencyUs = 50000;
+
+int64_t monotonicUs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+int openNode(const std::string& path) {
+    const auto deadline = std::chrono::steady_clock::now() + kNodeWait;
+    for (;;) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd >= 0 || errno != ENOENT || std::chrono::steady_clock::now() >= deadline) {
+            return fd;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+// Reads until count events arrived or the timeout passed
+std::vector<input_event> readEvents(int fd, size_t count) {
+    std::vector<input_event> events;
+    const auto deadline = std::chrono::steady_clock::now() + kReadTimeout;
+    while (events.size() < count && std::chrono::steady_clock::now() < deadline) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+        input_event buffer[16];
+        const ssize_t bytes = ::read(fd, buffer, sizeof(buffer));
+        for (ssize_t i = 0; bytes > 0 && i < bytes / static_cast<ssize_t>(sizeof(input_event)); ++i) {
+            events.push_back(buffer[i]);
+        }
+    }
+    return events;
+}
+
+bool isKey(const input_event& event, uint16_t code, int value) {
+    return event.type == EV_KEY && event.code == code && event.value == value;
+}
+
+bool isSyn(const input_event& event) {
+    return event.type == EV_SYN && event.code == SYN_REPORT;
+}
+
+int64_t eventTimeUs(const input_event& event) {
+    return static_cast<int64_t>(event.input_event_sec) * 1000000 + event.input_event_usec;
+}
+
+} // end anonymous namespace
+
+int main() {
+    if (access("/dev/uinput", W_OK) != 0) {
+        std::printf("uinputkeyboard_test: skipped, /dev/uinput is not writable\n");
+        return kTestSkipped;
+    }
+
+    UinputKeyboard keyboard;
+    std::string error;
+    if (!keyboard.open(&error)) {
+        std::printf("uinputkeyboard_test: skipped, %s\n", error.c_str());
+        return kTestSkipped;
+    }
+    CHECK(!keyboard.devicePath().empty());
+
+    const int fd = keyboard.devicePath().empty() ? -1 : openNode(keyboard.devicePath());
+    if (fd < 0) {
+        std::printf("uinputkeyboard_test: skipped, cannot read %s: %s\n", keyboard.devicePath().c_str(),
+                    std::strerror(errno));
+        return kTestSkipped;
+    }
+    // Timestamps on the same clock as monotonicUs()
+    int clockId = CLOCK_MONOTONIC;
+    CHECK(ioctl(fd, EVIOCSCLOCKID, &clockId) == 0);
+
+    // A chord through send(), then its release through the prepared-record path
+    const uint16_t codes[] = {KEY_A, KEY_B};
+    const bool downs[] = {true, true};
+    const int64_t pressSentUs = monotonicUs();
+    CHECK(keyboard.send(codes, downs, 2));
+
+    const input_event releases[] = {UinputKeyboard::keyEvent(KEY_A, false), UinputKeyboard::keyEvent(KEY_B, false)};
+    const int64_t releaseSentUs = monotonicUs();
+    CHECK(keyboard.sendEvents(releases, 2));
+
+    // Each batch comes back as its key events followed by one SYN_REPORT
+    const std::vector<input_event> events = readEvents(fd, 6);
+    CHECK(events.size() == 6);
+    if (events.size() == 6) {
+        CHECK(isKey(events[0], KEY_A, 1));
+        CHECK(isKey(events[1], KEY_B, 1));
+        CHECK(isSyn(events[2]));
+        CHECK(isKey(events[3], KEY_A, 0));
+        CHECK(isKey(events[4], KEY_B, 0));
+        CHECK(isSyn(events[5]));
+
+        // Events of one batch share the kernel's timestamp
+        CHECK(eventTimeUs(events[0]) == eventTimeUs(events[2]));
+        const int64_t pressLatencyUs = eventTimeUs(events[0]) - pressSentUs;
+        const int64_t releaseLatencyUs = eventTimeUs(events[3]) - releaseSentUs;
+        CHECK(pressLatencyUs >= 0 && pressLatencyUs < kMaxLatencyUs);
+        CHECK(releaseLatencyUs >= 0 && releaseLatencyUs < kMaxLatencyUs);
+        std::printf("uinputkeyboard_test: write-to-delivery latency %lld us, %lld us\n",
+                    static_cast<long long>(pressLatencyUs), static_cast<long long>(releaseLatencyUs));
+    }
+
+    ::close(fd);
+    keyboard.close();
+    return testResult("uinputkeyboard_test");
+}